@@ -0,0 +1,54 @@
+//
+//  AliasTable.cpp
+//  Mario Typer
+//
+
+#import "AliasTable.hpp"
+
+bool AliasTable::build(const std::vector<double>& weights)
+{
+    clear();
+    size_t n = weights.size();
+    double total = 0;
+    for(double weight : weights) {
+        if(!(weight >= 0))
+            return false;
+        total += weight;
+    }
+    if(n == 0 || !(total > 0))
+        return false;
+
+    // scale so the average slot is exactly full, then let every underfull
+    // slot borrow the rest of its space from an overfull one
+    std::vector<double> scaled(n);
+    std::vector<uint32_t> small, large;
+    small.reserve(n);
+    large.reserve(n);
+    for(size_t i=0; i<n; i++) {
+        scaled[i] = weights[i] * n / total;
+        (scaled[i] < 1 ? small : large).push_back((uint32_t)i);
+    }
+    entries.resize(n);
+    while(!small.empty() && !large.empty()) {
+        uint32_t less = small.back();
+        small.pop_back();
+        uint32_t more = large.back();
+        entries[less].threshold = (uint32_t)(scaled[less] * 4294967296.0);
+        entries[less].alias = more;
+        scaled[more] -= 1 - scaled[less];
+        if(scaled[more] < 1) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // whatever is left is full up to rounding error
+    for(uint32_t i : large) {
+        entries[i].threshold = UINT32_MAX;
+        entries[i].alias = i;
+    }
+    for(uint32_t i : small) {
+        entries[i].threshold = UINT32_MAX;
+        entries[i].alias = i;
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+//
+//  AliasTable.hpp
+//  Mario Typer
+//
+//  Draws index i with probability weight[i] / sum(weights) in constant
+//  time, whatever the number of items (Walker's alias method, built with
+//  Vose's algorithm). Each slot holds its own index up to a threshold and
+//  an alias above it, so a sample is one uniform slot and one comparison.
+//
+
+#ifndef AliasTable_hpp
+#define AliasTable_hpp
+
+#import <stddef.h>
+#import <stdint.h>
+#import <vector>
+#import "Random.hpp"
+
+class AliasTable
+{
+    struct Entry
+    {
+        uint32_t threshold; // keep this slot if a 32-bit draw is below it
+        uint32_t alias;
+    };
+    std::vector<Entry> entries;
+
+public:
+    // weights must be non-negative with a positive sum; false leaves the table empty
+    bool build(const std::vector<double>& weights);
+    void clear() { std::vector<Entry>().swap(entries); }
+
+    bool empty() const { return entries.empty(); }
+    unsigned int size() const { return (unsigned int)entries.size(); }
+    size_t memoryUsed() const { return entries.capacity()*sizeof(Entry); }
+
+    unsigned int sample(Random& rng) const
+    {
+        uint32_t i = rng.below((uint32_t)entries.size());
+        return rng.next() < entries[i].threshold ? i : entries[i].alias;
+    }
+};
+
+#endif /* AliasTable_hpp */
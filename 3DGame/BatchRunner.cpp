@@ -0,0 +1,116 @@
+//
+//  BatchRunner.cpp
+//  Mario Typer
+//
+
+#import <stdio.h>
+#import <algorithm>
+#import <atomic>
+#import <chrono>
+#import <thread>
+#import "BatchRunner.hpp"
+#import "SyntheticInput.hpp"
+#import "WorkStealingPool.hpp"
+
+// splitmix32-style mixing, so neighbouring game numbers get unrelated seeds
+unsigned int BatchRunner::gameSeed(unsigned int batchSeed, int game)
+{
+    unsigned int z = batchSeed + 0x9e3779b9u * (unsigned int)(game + 1);
+    z = (z ^ (z >> 16)) * 0x85ebca6bu;
+    z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+    return z ^ (z >> 16);
+}
+
+BatchSummary BatchRunner::run()
+{
+    BatchSummary summary;
+    int threads = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+    if(threads < 1) threads = 1;
+    summary.threads = threads;
+    summary.games.resize(options.games);
+    
+    // one Scene and input source per worker, reused from game to game
+    std::vector<Scene*> scenes(threads, (Scene*)NULL);
+    std::vector<InputSource*> inputs(threads, (InputSource*)NULL);
+    std::atomic<long long> steps(0);
+    float dt = 1/options.hz;
+    
+    WorkStealingPool pool(threads);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pool.run(options.games, [&](int worker, int game) {
+        if(scenes[worker] == NULL) {
+            scenes[worker] = new Scene();
+            scenes[worker]->setVerbose(options.verbose);
+            scenes[worker]->setAnyLane(options.anyLane);
+            scenes[worker]->setLaneCount(options.lanes);
+            scenes[worker]->setWaves(options.waves);
+            scenes[worker]->initialize();
+            if(options.script)
+                inputs[worker] = new InputScript(options.script);
+            else
+                inputs[worker] = new Typist(0, options.charsPerSecond, options.accuracy);
+        }
+        Scene& scene = *scenes[worker];
+        InputSource& source = *inputs[worker];
+        
+        unsigned int seed = gameSeed(options.seed, game);
+        scene.seed(seed);
+        scene.reset();
+        source.reset();
+        source.seed(seed);
+        InputQueue input;
+        
+        // cap on simulated time, counting paused steps too
+        long long gameSteps = 0;
+        long long maxSteps = (long long)(options.maxTime * options.hz);
+        while(!scene.isGameOver() && gameSteps < maxSteps) {
+            source.control(dt, scene, input);
+            scene.control(dt, input);
+            gameSteps++;
+        }
+        steps += gameSteps;
+        summary.games[game] = scene.getStats();
+        if(options.verbose)
+            printf("Game %d: survived %.1f s, %d words, %d kills\n", game+1,
+                   summary.games[game].survivalTime, summary.games[game].wordsTyped, summary.games[game].enemiesKilled);
+    });
+    summary.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    summary.steps = steps;
+    
+    for(int i=0; i<threads; i++) {
+        delete scenes[i];
+        delete inputs[i];
+    }
+    return summary;
+}
+
+void printSummary(const BatchSummary& summary, float hz)
+{
+    int n = (int)summary.games.size();
+    if(n == 0) return;
+    std::vector<float> survival;
+    long long words = 0;
+    long long kills = 0;
+    int peakEnemies = 0, peakFireballs = 0;
+    for(const GameStats& stats : summary.games) {
+        survival.push_back(stats.survivalTime);
+        words += stats.wordsTyped;
+        kills += stats.enemiesKilled;
+        peakEnemies = std::max(peakEnemies, stats.peakEnemies);
+        peakFireballs = std::max(peakFireballs, stats.peakFireballs);
+    }
+    std::sort(survival.begin(), survival.end());
+    double total = 0;
+    for(float s : survival) total += s;
+    
+    printf("Games: %d on %d threads\n", n, summary.threads);
+    printf("Survival (s): avg %.1f  min %.1f  p50 %.1f  p90 %.1f  max %.1f\n",
+           total/n, survival[0], survival[n/2], survival[(n*9)/10 < n ? (n*9)/10 : n-1], survival[n-1]);
+    printf("Words typed: %lld (avg %.1f per game)\n", words, (double)words/n);
+    printf("Enemies killed: %lld (avg %.1f per game)\n", kills, (double)kills/n);
+    printf("Most alive at once: %d enemies, %d fireballs\n", peakEnemies, peakFireballs);
+    double simulated = summary.steps / (double)hz;
+    double wall = summary.wallTime > 0 ? summary.wallTime : 1e-9;
+    printf("Simulated %.0f s in %.2f s wall time (%.0fx real time, %.0f steps/s)\n",
+           simulated, summary.wallTime, simulated/wall, summary.steps/wall);
+}
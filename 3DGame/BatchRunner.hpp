@@ -0,0 +1,52 @@
+//
+//  BatchRunner.hpp
+//  Mario Typer
+//
+//  Plays many independent headless games in parallel. Every game gets its
+//  own seed derived from the batch seed, so a batch gives the same results
+//  no matter how many threads run it or in which order games finish.
+//
+
+#ifndef BatchRunner_hpp
+#define BatchRunner_hpp
+
+#import <vector>
+#import "Scene.hpp"
+#import "WaveSchedule.hpp"
+
+struct BatchOptions
+{
+    int games = 100;
+    unsigned int seed = 0;
+    float hz = 60;
+    float charsPerSecond = 6;  // bot typist speed
+    float accuracy = 0.95f;    // bot typist hit rate
+    float maxTime = 600;       // simulated seconds before a game is cut off
+    const char* script = NULL; // key tap script instead of the bot typist
+    int threads = 0;           // 0 = one per hardware thread
+    bool verbose = false;
+    bool anyLane = false;      // type at every lane without turning
+    int lanes = 4;             // stations around the avatar
+    WaveSchedule waves;        // empty: classic spawning
+};
+
+struct BatchSummary
+{
+    std::vector<GameStats> games; // indexed by game number
+    long long steps = 0;
+    double wallTime = 0;
+    int threads = 0;
+};
+
+class BatchRunner
+{
+    BatchOptions options;
+public:
+    BatchRunner(const BatchOptions& options):options(options) {}
+    BatchSummary run();
+    static unsigned int gameSeed(unsigned int batchSeed, int game);
+};
+
+void printSummary(const BatchSummary& summary, float hz);
+
+#endif /* BatchRunner_hpp */
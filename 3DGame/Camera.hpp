@@ -0,0 +1,179 @@
+//
+//  Camera.hpp
+//  Mario Typer
+//
+
+#ifndef Camera_hpp
+#define Camera_hpp
+
+#define _USE_MATH_DEFINES
+#import <math.h>
+#import <vector>
+#import "Platform.hpp"
+#import "float2.h"
+#import "float3.h"
+
+class Camera
+{
+    float3 eye;
+    float3 previousEye;
+    float3 previousLookAt;
+    
+    float3 ahead;
+    float3 lookAt;
+    float3 right;
+    float3 up;
+    
+    float fov;
+    float aspect;
+    
+    float2 lastMousePos;
+    float2 mouseDelta;
+    
+    bool inMotion = false;
+    bool moveLeft = false;
+    int queuedTurn = 0; // 1 = left, -1 = right: a tapped arrow key not yet acted on
+    float motionAngle = 0;
+    float motionStep = 0; // degrees turned during the last move()
+    float turnSpeed = 300; // degrees per second
+    float turnAngle = 90; // degrees from one station to the next
+    
+public:
+    float3 getEye()
+    {
+        return eye;
+    }
+    Camera()
+    {
+        eye = float3(0, 0.75, 0);
+        lookAt = float3(0, 0, 0);
+        right = float3(1, 0, 0);
+        up = float3(0, 1, 0);
+        
+        fov = 1.1;
+        aspect  = 1;
+        
+        previousEye = eye;
+        previousLookAt = lookAt;
+    }
+    
+    void apply(float alpha)
+    {
+#ifndef HEADLESS
+        // interpolate between the last two simulation steps
+        float3 e = previousEye + (eye - previousEye) * alpha;
+        float3 l = previousLookAt + (lookAt - previousLookAt) * alpha;
+        glMatrixMode(GL_PROJECTION);
+        glLoadIdentity();
+        gluPerspective(fov /3.14*180, aspect, 0.1, 500);
+        glMatrixMode(GL_MODELVIEW);
+        glLoadIdentity();
+        gluLookAt(e.x, e.y, e.z, l.x, l.y, l.z, 0.0, 1.0, 0.0);
+#endif
+    }
+    
+    void setAspectRatio(float ar) { aspect= ar; }
+    void setTurnAngle(float degrees) { turnAngle = degrees; }
+    
+    // turn at the next opportunity, even if the key is already released by then
+    void queueTurn(bool left) { queuedTurn = left ? 1 : -1; }
+    
+    void move(float dt, std::vector<bool>& keysPressed, bool noClip)
+    {
+        previousEye = eye;
+        previousLookAt = lookAt;
+        
+        float yaw = atan2f( ahead.x, ahead.z );
+        float pitch = -atan2f( ahead.y, sqrtf(ahead.x * ahead.x + ahead.z * ahead.z) );
+        
+        if(noClip) {
+            
+            if(keysPressed.at('w'))
+                eye += ahead * dt * 20;
+            if(keysPressed.at('s'))
+                eye -= ahead * dt * 20;
+            if(keysPressed.at('a'))
+                eye -= right * dt * 20;
+            if(keysPressed.at('d'))
+                eye += right * dt * 20;
+            if(keysPressed.at('q'))
+                eye -= float3(0,1,0) * dt * 20;
+            if(keysPressed.at('e'))
+                eye += float3(0,1,0) * dt * 20;
+            
+            yaw -= mouseDelta.x * 0.02f;
+            pitch += mouseDelta.y * 0.02f;
+            
+        }
+        
+        motionStep = 0;
+        if(!inMotion) {
+            
+            if(queuedTurn > 0 || (queuedTurn == 0 && keysPressed.at(258))) { // left
+                inMotion = true;
+                moveLeft = true;
+            } else if(queuedTurn < 0 || keysPressed.at(259)) { //right
+                inMotion = true;
+                moveLeft = false;
+            }
+            queuedTurn = 0;
+            
+        } else {
+            
+            if(motionAngle < turnAngle) {
+                motionStep = fmin(turnSpeed * dt, turnAngle - motionAngle);
+                if(!noClip)
+                    yaw += (moveLeft ? 1 : -1) * (motionStep/180) * M_PI;
+                motionAngle += motionStep;
+            } else {
+                inMotion = false;
+                motionAngle = 0;
+            }
+            
+        }
+        
+        if(pitch > 3.14/2) pitch = 3.14/2;
+        if(pitch < -3.14/2) pitch = -3.14/2;
+        
+        mouseDelta = float2(0, 0);
+        
+        ahead = float3(sin(yaw)*cos(pitch), -sin(pitch), cos(yaw)*cos(pitch) );
+        right = ahead.cross(float3(0, 1, 0)).normalize();
+        up = right.cross(ahead);
+        lookAt = eye + ahead;
+    }
+    
+    void startDrag(int x, int y)
+    {
+        lastMousePos = float2(x, y);
+    }
+    void drag(int x, int y)
+    {
+        float2 mousePos(x, y);
+        mouseDelta = mousePos - lastMousePos;
+        lastMousePos = mousePos;
+    }
+    void endDrag()
+    {
+        mouseDelta = float2(0, 0);
+    }
+    
+    bool isMoving() {
+        return inMotion;
+    }
+    
+    bool movingLeft() {
+        return moveLeft;
+    }
+    
+    float getMotionAngle() {
+        return (motionAngle/180) * M_PI;
+    }
+    
+    float getMotionStep() {
+        return motionStep;
+    }
+    
+};
+
+#endif /* Camera_hpp */
@@ -0,0 +1,651 @@
+//
+//  Dictionary.cpp
+//  Mario Typer
+//
+
+#import <stdio.h>
+#import <ctype.h>
+#import <math.h>
+#import <string.h>
+#import <fcntl.h>
+#import <unistd.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <algorithm>
+#import <atomic>
+#import <condition_variable>
+#import <mutex>
+#import <thread>
+#import "Dictionary.hpp"
+#import "Timestep.hpp"
+#import "TypingDifficulty.hpp"
+
+PackedWords dictionary[3];
+const char* dictionaryImageFile = "ospd.dict";
+static WordWeighting wordWeighting;
+
+// Layout of a dictionary image, in native byte order so it can be used in
+// place: this header, then for each level its offset table (count+1 words),
+// its score table (count floats), its frequency table (count floats, if the
+// level's flag is set) and its blob, padded to 4 bytes.
+struct ImageHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t size;      // of the whole file
+    uint32_t checksum;  // of the header with this field zeroed, then the body; see imageChecksum()
+    uint32_t flags;     // bit 'level': that level has frequencies
+    uint32_t buckets[3][27];
+};
+
+static_assert(sizeof(ImageHeader) % 4 == 0, "the checksum reads the header as whole 32-bit words");
+
+static const char imageMagic[4] = { 'M', 'T', 'D', 'C' };
+static const uint32_t imageVersion = 4;
+
+// FNV-1a over 32-bit words rather than bytes (the body is padded to 4), so
+// validating a mapped image costs a fraction of a millisecond
+static uint32_t checksum(const unsigned char* data, size_t length, uint32_t hash = 2166136261u)
+{
+    for(size_t i=0; i+4<=length; i+=4) {
+        uint32_t word;
+        memcpy(&word, data + i, 4);
+        hash ^= word;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// the header sets every table size and where each table starts, so it is
+// covered too, as if its checksum field were zero
+static uint32_t imageChecksum(const ImageHeader& header, const unsigned char* body, size_t length)
+{
+    ImageHeader copy = header;
+    copy.checksum = 0;
+    return checksum(body, length, checksum((const unsigned char*)&copy, sizeof(copy)));
+}
+
+static size_t padded(size_t bytes) { return (bytes + 3) & ~(size_t)3; }
+
+// the tables pickRandomWord() uses; a streaming load swaps in new ones
+static std::atomic<const PackedWords*> activeWords(dictionary);
+
+PackedWords::PackedWords()
+{
+    memset(buckets, 0, sizeof(buckets));
+}
+
+const PackedWords* currentDictionary()
+{
+    return activeWords.load(std::memory_order_acquire);
+}
+
+void setWordWeighting(const WordWeighting& weighting)
+{
+    wordWeighting = weighting;
+}
+
+const WordWeighting& getWordWeighting()
+{
+    return wordWeighting;
+}
+
+void PackedWords::buildSampler(const WordWeighting& weighting)
+{
+    sampler.clear();
+    if(weighting.uniform() || count() == 0)
+        return;
+    std::vector<double> weights(count());
+    for(unsigned int n=0; n<count(); n++) {
+        double weight = 1;
+        if(weighting.frequencyExponent != 0)
+            weight *= pow(frequency(n), weighting.frequencyExponent);
+        if(weighting.difficultyExponent != 0)
+            weight *= pow(score(n), weighting.difficultyExponent);
+        if(weighting.lengthExponent != 0)
+            weight *= pow(word(n).length, weighting.lengthExponent);
+        weights[n] = weight;
+    }
+    if(!sampler.build(weights))
+        printf("Word weights of a level add up to nothing; drawing its words uniformly\n");
+}
+
+static void buildSamplers(PackedWords* levels)
+{
+    for(int level=0; level<3; level++)
+        levels[level].buildSampler(wordWeighting);
+}
+
+StringView pickRandomWord(int level, Random& rng)
+{
+    StringView none = { "", 0 };
+    if(level < 1 || level > 3)
+        return none;
+    const PackedWords& words = currentDictionary()[level-1];
+    if(words.count() == 0)
+        return none;
+    return words.word(words.sample(rng));
+}
+
+// the number after a word on its line, if there is one
+static bool parseFrequency(const char* text, size_t length, float& frequency)
+{
+    size_t i = 0;
+    while(i < length && (text[i] == ' ' || text[i] == '\t'))
+        i++;
+    double value = 0;
+    double scale = 0;
+    bool digits = false;
+    for(; i<length; i++) {
+        char c = text[i];
+        if(c >= '0' && c <= '9') {
+            digits = true;
+            if(scale > 0) {
+                value += (c - '0') * scale;
+                scale /= 10;
+            } else {
+                value = value*10 + (c - '0');
+            }
+        } else if(c == '.' && scale == 0) {
+            scale = 0.1;
+        } else {
+            break;
+        }
+    }
+    if(digits)
+        frequency = (float)value;
+    return digits;
+}
+
+// number of bytes in the UTF-8 sequence starting with lead, 0 if lead cannot start one
+static int sequenceLength(unsigned char lead)
+{
+    if(lead < 0x80) return 1;
+    if(lead >= 0xc2 && lead <= 0xdf) return 2;
+    if(lead >= 0xe0 && lead <= 0xef) return 3;
+    if(lead >= 0xf0 && lead <= 0xf4) return 4;
+    return 0;
+}
+
+void WordListBuilder::addLine(const char* line, size_t length)
+{
+    if(sourceStart) {
+        sourceStart = false;
+        if(length >= 3 && memcmp(line, "\xef\xbb\xbf", 3) == 0) {
+            line += 3;
+            length -= 3;
+        }
+    }
+    // the word is the first field, its frequency the optional second
+    size_t end = 0;
+    while(end < length && line[end] != ' ' && line[end] != '\t' && line[end] != '\r')
+        end++;
+
+    char word[10];
+    size_t letters = 0;
+    bool typeable = true;
+    for(size_t i=0; i<end; ) {
+        unsigned char c = line[i];
+        int bytes = sequenceLength(c);
+        if(bytes == 0 || i + bytes > end) {
+            invalid++;
+            return;
+        }
+        for(int k=1; k<bytes; k++) {
+            if(((unsigned char)line[i+k] & 0xc0) != 0x80) {
+                invalid++;
+                return;
+            }
+        }
+        if(bytes > 1 || !isalpha(c))
+            typeable = false;
+        else if(letters < 10)
+            word[letters] = tolower(c);
+        letters++;
+        i += bytes;
+    }
+    if(letters < 3 || letters > 10)
+        return;
+    if(!typeable) {
+        untypeable++;
+        return;
+    }
+
+    Bucket& bucket = buckets[word[0] - 'a'];
+    if(bucket.offsets.empty())
+        bucket.offsets.push_back(0);
+    bucket.bytes.insert(bucket.bytes.end(), word, word + letters);
+    bucket.offsets.push_back((uint32_t)bucket.bytes.size());
+    float frequency = 1;
+    if(parseFrequency(line + end, length - end, frequency))
+        hasFrequencies = true;
+    bucket.frequencies.push_back(frequency);
+    accepted++;
+    // progress at 50k, 100k, 200k... so that huge lists do not flood the log
+    if(accepted == nextReport) {
+        printf("Parsed %d words...\n", accepted);
+        nextReport *= 2;
+    }
+}
+
+void WordListBuilder::feed(const char* data, size_t size)
+{
+    const char* end = data + size;
+    while(data < end) {
+        const char* newline = (const char*)memchr(data, '\n', end - data);
+        if(newline == NULL) {
+            partial.append(data, end - data);
+            return;
+        }
+        if(partial.empty()) {
+            addLine(data, newline - data);
+        } else {
+            partial.append(data, newline - data);
+            addLine(partial.data(), partial.length());
+            partial.clear();
+        }
+        data = newline + 1;
+    }
+}
+
+void WordListBuilder::endSource()
+{
+    if(!partial.empty())
+        addLine(partial.data(), partial.length());
+    partial.clear();
+}
+
+void WordListBuilder::pack(PackedWords* levels)
+{
+    // every bucket is already a blob and an offset table, so it scores in one pass
+    std::vector<float> scores[26];
+    std::vector<float> sorted;
+    sorted.reserve(accepted);
+    for(int letter=0; letter<26; letter++) {
+        const Bucket& bucket = buckets[letter];
+        scores[letter].resize(bucket.count());
+        if(bucket.count())
+            scoreWords(bucket.bytes.data(), bucket.offsets.data(), bucket.count(), scores[letter].data());
+        sorted.insert(sorted.end(), scores[letter].begin(), scores[letter].end());
+    }
+    // the easiest, middle and hardest thirds
+    levelCuts[0] = levelCuts[1] = 0;
+    if(!sorted.empty()) {
+        size_t third = sorted.size() / 3;
+        std::nth_element(sorted.begin(), sorted.begin() + third, sorted.end());
+        levelCuts[0] = sorted[third];
+        std::nth_element(sorted.begin() + third, sorted.begin() + 2*third, sorted.end());
+        levelCuts[1] = sorted[2*third];
+    }
+    std::vector<float>().swap(sorted);
+    auto levelOf = [&](float score) { return score < levelCuts[0] ? 0 : score < levelCuts[1] ? 1 : 2; };
+
+    uint32_t counts[3][26] = {};
+    size_t bytes[3] = {};
+    for(int letter=0; letter<26; letter++) {
+        const Bucket& bucket = buckets[letter];
+        for(unsigned int i=0; i<bucket.count(); i++) {
+            int level = levelOf(scores[letter][i]);
+            counts[level][letter]++;
+            bytes[level] += bucket.offsets[i+1] - bucket.offsets[i];
+        }
+    }
+    for(int level=0; level<3; level++) {
+        PackedWords& words = levels[level];
+        words.buckets[0] = 0;
+        for(int letter=0; letter<26; letter++)
+            words.buckets[letter+1] = words.buckets[letter] + counts[level][letter];
+        words.blobStorage.assign(bytes[level], 0);
+        words.offsetStorage.assign(words.count() + 1, 0);
+        words.scoreStorage.assign(words.count(), 0);
+        words.frequencyStorage.assign(hasFrequencies ? words.count() : 0, 0);
+    }
+
+    // letters in order, so each level's words stay grouped by first letter
+    uint32_t n[3] = {};
+    uint32_t start[3] = {};
+    for(int letter=0; letter<26; letter++) {
+        const Bucket& bucket = buckets[letter];
+        for(unsigned int i=0; i<bucket.count(); i++) {
+            float score = scores[letter][i];
+            int level = levelOf(score);
+            PackedWords& words = levels[level];
+            uint32_t length = bucket.offsets[i+1] - bucket.offsets[i];
+            memcpy(&words.blobStorage[start[level]], &bucket.bytes[bucket.offsets[i]], length);
+            words.offsetStorage[n[level]] = start[level];
+            words.scoreStorage[n[level]] = score;
+            if(hasFrequencies)
+                words.frequencyStorage[n[level]] = bucket.frequencies[i];
+            n[level]++;
+            start[level] += length;
+        }
+    }
+    for(int level=0; level<3; level++) {
+        PackedWords& words = levels[level];
+        // the end of the last word; every other word ends where the next begins
+        words.offsetStorage[n[level]] = start[level];
+        words.blob = words.blobStorage.data();
+        words.offsets = words.offsetStorage.data();
+        words.scores = words.scoreStorage.data();
+        words.frequencies = hasFrequencies ? words.frequencyStorage.data() : NULL;
+    }
+}
+
+void WordListBuilder::clear()
+{
+    for(int letter=0; letter<26; letter++) {
+        std::vector<char>().swap(buckets[letter].bytes);
+        std::vector<uint32_t>().swap(buckets[letter].offsets);
+        std::vector<float>().swap(buckets[letter].frequencies);
+    }
+    std::string().swap(partial);
+    accepted = untypeable = invalid = 0;
+    hasFrequencies = false;
+    nextReport = 50000;
+}
+
+static const size_t chunkSize = 1 << 16;
+
+// feeds a whole source through the builder; onChunk() runs after every chunk
+template <typename OnChunk>
+static bool streamSource(WordSource& source, WordListBuilder& builder, std::vector<char>& chunk, OnChunk onChunk)
+{
+    if(!source.open())
+        return false;
+    builder.beginSource();
+    size_t size;
+    while((size = source.read(chunk.data(), chunk.size())) > 0) {
+        builder.feed(chunk.data(), size);
+        onChunk();
+    }
+    builder.endSource();
+    return true;
+}
+
+static void printSummary(const WordListBuilder& builder, const PackedWords* levels)
+{
+    printf("Done. Parsed %d words. \n(Lvl1: %d, Lvl2: %d, Lvl3: %d)\n", builder.accepted,
+           levels[0].count(), levels[1].count(), levels[2].count());
+    printf("Levels 2 and 3 start at typing difficulty %.2f and %.2f\n", builder.levelCuts[0], builder.levelCuts[1]);
+    if(builder.untypeable || builder.invalid)
+        printf("Skipped %d words with letters other than a-z and %d lines that are not UTF-8\n",
+               builder.untypeable, builder.invalid);
+}
+
+bool parseDictionary(const char* filename)
+{
+    FileWordSource source(filename);
+    WordListBuilder builder;
+    std::vector<char> chunk(chunkSize);
+    printf("Parsing dictionary...\n");
+    if(!streamSource(source, builder, chunk, []() {}))
+        return false;
+    builder.pack(dictionary);
+    printSummary(builder, dictionary);
+    return true;
+}
+
+bool saveDictionaryImage(const char* filename)
+{
+    ImageHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, imageMagic, 4);
+    header.version = imageVersion;
+    std::vector<unsigned char> body;
+    for(int level=0; level<3; level++) {
+        const PackedWords& words = dictionary[level];
+        memcpy(header.buckets[level], words.buckets, sizeof(words.buckets));
+        const unsigned char* offsets = (const unsigned char*)words.offsets;
+        if(offsets)
+            body.insert(body.end(), offsets, offsets + (words.count()+1)*sizeof(uint32_t));
+        else
+            body.resize(body.size() + sizeof(uint32_t), 0);
+        const unsigned char* scores = (const unsigned char*)words.scores;
+        if(scores)
+            body.insert(body.end(), scores, scores + words.count()*sizeof(float));
+        if(words.frequencies) {
+            header.flags |= 1 << level;
+            const unsigned char* frequencies = (const unsigned char*)words.frequencies;
+            body.insert(body.end(), frequencies, frequencies + words.count()*sizeof(float));
+        }
+        body.insert(body.end(), words.blob, words.blob + words.blobSize());
+        body.resize(padded(body.size()), 0);
+    }
+    header.size = (uint32_t)(sizeof(header) + body.size());
+    header.checksum = imageChecksum(header, body.data(), body.size());
+
+    FILE* file = fopen(filename, "wb");
+    if(!file) {
+        printf("Could not write dictionary image %s\n", filename);
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+              && fwrite(body.data(), 1, body.size(), file) == body.size();
+    ok = fclose(file) == 0 && ok;
+    if(!ok)
+        printf("Could not write dictionary image %s\n", filename);
+    return ok;
+}
+
+bool loadDictionaryImage(const char* filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0)
+        return false;
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(ImageHeader)) {
+        close(fd);
+        printf("Dictionary image %s is too short\n", filename);
+        return false;
+    }
+    size_t size = info.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED) {
+        printf("Could not map dictionary image %s\n", filename);
+        return false;
+    }
+
+    const unsigned char* data = (const unsigned char*)mapping;
+    const ImageHeader* header = (const ImageHeader*)data;
+    const char* problem = NULL;
+    if(memcmp(header->magic, imageMagic, 4) != 0 || header->version != imageVersion)
+        problem = "is not a dictionary image of this version";
+    else if(header->size != size)
+        problem = "is truncated";
+    else if(imageChecksum(*header, data + sizeof(ImageHeader), size - sizeof(ImageHeader)) != header->checksum)
+        problem = "fails its checksum";
+
+    // every table has to fit inside the file before anything points into it
+    const uint32_t* offsets[3] = {};
+    const float* scores[3] = {};
+    const float* frequencies[3] = {};
+    const char* blobs[3] = {};
+    size_t position = sizeof(ImageHeader);
+    for(int level=0; level<3 && !problem; level++) {
+        const uint32_t* buckets = header->buckets[level];
+        bool ordered = buckets[0] == 0;
+        for(int letter=0; letter<26; letter++)
+            if(buckets[letter+1] < buckets[letter])
+                ordered = false;
+        size_t tableBytes = ((size_t)buckets[26] + 1)*sizeof(uint32_t);
+        if(!ordered || position + tableBytes > size) {
+            problem = "has a corrupt bucket table";
+            break;
+        }
+        offsets[level] = (const uint32_t*)(data + position);
+        position += tableBytes;
+        size_t scoreBytes = (size_t)buckets[26]*sizeof(float);
+        if(position + scoreBytes > size) {
+            problem = "has a corrupt score table";
+            break;
+        }
+        scores[level] = (const float*)(data + position);
+        position += scoreBytes;
+        if(header->flags & (1 << level)) {
+            size_t frequencyBytes = (size_t)buckets[26]*sizeof(float);
+            if(position + frequencyBytes > size) {
+                problem = "has a corrupt frequency table";
+                break;
+            }
+            frequencies[level] = (const float*)(data + position);
+            position += frequencyBytes;
+        }
+        size_t blobBytes = offsets[level][buckets[26]];
+        if(position + blobBytes > size) {
+            problem = "has a corrupt offset table";
+            break;
+        }
+        blobs[level] = (const char*)(data + position);
+        position = padded(position + blobBytes);
+    }
+    if(problem) {
+        printf("Dictionary image %s %s\n", filename, problem);
+        munmap(mapping, size);
+        return false;
+    }
+
+    // the mapping stays for the rest of the program
+    for(int level=0; level<3; level++) {
+        PackedWords& words = dictionary[level];
+        memcpy(words.buckets, header->buckets[level], sizeof(words.buckets));
+        words.offsets = offsets[level];
+        words.scores = scores[level];
+        words.frequencies = frequencies[level];
+        words.blob = blobs[level];
+        words.offsetStorage.clear();
+        words.scoreStorage.clear();
+        words.frequencyStorage.clear();
+        words.blobStorage.clear();
+    }
+    return true;
+}
+
+#ifdef EMBEDDED_DICTIONARY
+
+void loadDictionary()
+{
+    // nothing to read: the tables are static data in the executable
+    for(int level=0; level<3; level++) {
+        PackedWords& words = dictionary[level];
+        memcpy(words.buckets, embeddedBuckets[level], sizeof(words.buckets));
+        words.offsets = embeddedOffsets[level];
+        words.scores = embeddedScores[level];
+        words.frequencies = embeddedFrequencies[level];
+        words.blob = embeddedWords[level];
+    }
+    buildSamplers(dictionary);
+}
+
+void addWordSource(WordSource* source)
+{
+    printf("Ignoring word list %s: this build has its dictionary compiled in\n", source->name());
+    delete source;
+}
+
+void waitForDictionary() {}
+
+#else
+
+// State of the streaming load. It is never freed: the loader thread is
+// detached, and the game may exit while it is still reading.
+struct StreamingLoad
+{
+    std::vector<WordSource*> sources;
+    WordListBuilder builder;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool started = false;
+    bool ready = false; // every level has a word
+    bool done = false;
+};
+
+static StreamingLoad& streamingLoad()
+{
+    static StreamingLoad* load = new StreamingLoad();
+    return *load;
+}
+
+static void streamWordSources(StreamingLoad* load)
+{
+    std::vector<char> chunk(chunkSize);
+    double start = monotonicSeconds();
+    bool published = false;
+    for(WordSource* source : load->sources) {
+        streamSource(*source, load->builder, chunk, [&]() {
+            if(published || !load->builder.hasThreeWords())
+                return;
+            // The first tables only hold what has arrived so far. They stay
+            // allocated, since a game may still be reading a word from them.
+            PackedWords* first = new PackedWords[3];
+            load->builder.pack(first);
+            // words tied at a cut all go to the level above, so wait for more
+            // words while a level is still empty
+            if(first[0].count() == 0 || first[1].count() == 0 || first[2].count() == 0) {
+                delete[] first;
+                return;
+            }
+            buildSamplers(first);
+            activeWords.store(first, std::memory_order_release);
+            published = true;
+            printf("Dictionary ready after %.1f ms with %d words, still loading\n",
+                   (monotonicSeconds() - start)*1000, load->builder.accepted);
+            std::lock_guard<std::mutex> lock(load->mutex);
+            load->ready = true;
+            load->changed.notify_all();
+        });
+        delete source;
+    }
+    load->sources.clear();
+
+    // nobody reads dictionary[] until it is published here
+    load->builder.pack(dictionary);
+    buildSamplers(dictionary);
+    activeWords.store(dictionary, std::memory_order_release);
+    printSummary(load->builder, dictionary);
+    for(int level=0; level<3; level++)
+        if(dictionary[level].count() == 0)
+            printf("No words for level %d; it will not spawn enemies\n", level+1);
+    load->builder.clear();
+
+    std::lock_guard<std::mutex> lock(load->mutex);
+    load->done = true;
+    load->changed.notify_all();
+}
+
+void addWordSource(WordSource* source)
+{
+    streamingLoad().sources.push_back(source);
+}
+
+void loadDictionary()
+{
+    StreamingLoad& load = streamingLoad();
+    if(load.sources.empty()) {
+        double start = monotonicSeconds();
+        if(loadDictionaryImage(dictionaryImageFile)) {
+            printf("Loaded dictionary image %s in %.2f ms (Lvl1: %d, Lvl2: %d, Lvl3: %d)\n", dictionaryImageFile,
+                   (monotonicSeconds() - start)*1000, dictionary[0].count(), dictionary[1].count(), dictionary[2].count());
+            buildSamplers(dictionary);
+            return;
+        }
+        load.sources.push_back(new FileWordSource("ospd.txt"));
+    }
+    printf("Parsing dictionary...\n");
+    load.started = true;
+    std::thread(streamWordSources, &load).detach();
+
+    std::unique_lock<std::mutex> lock(load.mutex);
+    load.changed.wait(lock, [&]() { return load.ready || load.done; });
+}
+
+void waitForDictionary()
+{
+    StreamingLoad& load = streamingLoad();
+    if(!load.started)
+        return;
+    std::unique_lock<std::mutex> lock(load.mutex);
+    load.changed.wait(lock, [&]() { return load.done; });
+}
+
+#endif // EMBEDDED_DICTIONARY
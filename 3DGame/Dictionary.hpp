@@ -0,0 +1,186 @@
+//
+//  Dictionary.hpp
+//  Mario Typer
+//
+//  The word list, packed for lookup rather than editing. Each difficulty
+//  level keeps all of its words back to back in one char blob, grouped by
+//  first letter, plus one table of 32-bit offsets into that blob, so loading
+//  ospd.txt makes two allocations per level instead of one per word.
+//  The same tables can be saved as a binary image (see DictionaryCompiler)
+//  which later launches map straight into memory instead of parsing, or
+//  compiled into the program itself (EMBEDDED_DICTIONARY, kiosk builds).
+//  Plain word lists are streamed from WordSources on a background thread;
+//  the game starts on a first, partial set of tables and switches to the
+//  full ones when the load finishes.
+//
+//  Levels are not word lengths but thirds of the list by typing difficulty
+//  (TypingDifficulty.hpp): level 1 is the easiest third to type. Every word's
+//  score is kept next to it, in the image and the compiled-in tables too.
+//
+
+#ifndef Dictionary_hpp
+#define Dictionary_hpp
+
+#import <stdint.h>
+#import <stddef.h>
+#import <vector>
+#import <string>
+#import "Random.hpp"
+#import "AliasTable.hpp"
+#import "WordSource.hpp"
+
+// A word inside a blob: pointer and length, not owned and not null-terminated
+// (C++11 has no std::string_view)
+struct StringView
+{
+    const char* data;
+    unsigned int length;
+
+    std::string str() const { return std::string(data, length); }
+};
+
+// How likely each word of a level is to be drawn: proportional to
+// frequency^frequencyExponent * score^difficultyExponent * length^lengthExponent,
+// where score is the word's typing difficulty.
+// All zero (the default) makes every word of a level equally likely.
+struct WordWeighting
+{
+    float frequencyExponent = 0;
+    float difficultyExponent = 0;
+    float lengthExponent = 0;
+
+    bool uniform() const { return frequencyExponent == 0 && difficultyExponent == 0 && lengthExponent == 0; }
+};
+
+// Words of one difficulty level. Word i runs from offsets[i] to offsets[i+1];
+// the words starting with 'a'+letter are numbered buckets[letter] up to
+// buckets[letter+1]. The tables either live in the vectors below (parsed from
+// text) or in a mapped dictionary image.
+class PackedWords
+{
+    const char* blob = NULL;
+    const uint32_t* offsets = NULL;
+    const float* scores = NULL;      // typing difficulty per word
+    const float* frequencies = NULL; // per word, if the list had a frequency column
+    uint32_t buckets[27];
+    std::vector<char> blobStorage;
+    std::vector<uint32_t> offsetStorage;
+    std::vector<float> scoreStorage;
+    std::vector<float> frequencyStorage;
+    AliasTable sampler; // empty when every word is equally likely
+
+    friend class WordListBuilder;
+    friend bool saveDictionaryImage(const char* filename);
+    friend bool loadDictionaryImage(const char* filename);
+    friend void loadDictionary();
+
+public:
+    PackedWords();
+
+    unsigned int count() const { return buckets[26]; }
+    unsigned int bucketSize(int letter) const { return buckets[letter+1] - buckets[letter]; }
+    StringView word(unsigned int n) const
+    {
+        StringView view = { blob + offsets[n], offsets[n+1] - offsets[n] };
+        return view;
+    }
+    StringView word(int letter, unsigned int i) const { return word(buckets[letter] + i); }
+    float score(unsigned int n) const { return scores[n]; }
+    float frequency(unsigned int n) const { return frequencies ? frequencies[n] : 1; }
+
+    // builds the alias table for a weighting (or drops it, for uniform)
+    void buildSampler(const WordWeighting& weighting);
+    // a word number drawn according to the weighting, in constant time
+    unsigned int sample(Random& rng) const { return sampler.empty() ? rng.below(count()) : sampler.sample(rng); }
+
+    const uint32_t* getBuckets() const { return buckets; }
+    const uint32_t* getOffsets() const { return offsets; }
+    const float* getScores() const { return scores; }
+    const float* getFrequencies() const { return frequencies; }
+    const char* getBlob() const { return blob; }
+    size_t blobSize() const { return offsets ? offsets[count()] : 0; }
+    size_t memoryUsed() const
+    {
+        return blobSize() + (count()+1)*sizeof(uint32_t) + count()*sizeof(float)
+               + (frequencies ? count()*sizeof(float) : 0);
+    }
+};
+
+// indexed by level-1
+extern PackedWords dictionary[3];
+
+// Sorts words into per-letter buckets as their bytes arrive, in chunks of any
+// size and in any order, then scores them and packs them into PackedWords
+// tables, split into levels at the thirds of the scores seen so far. Input
+// is UTF-8, one word per line, optionally followed by a space or tab and the
+// word's frequency. Words must be 3 to 10 letters; words with letters the
+// keyboard cannot type (anything but a-z) are skipped.
+class WordListBuilder
+{
+    struct Bucket
+    {
+        std::vector<char> bytes;
+        std::vector<uint32_t> offsets; // a leading 0, then the end of each word
+        std::vector<float> frequencies;
+
+        unsigned int count() const { return offsets.empty() ? 0 : (unsigned int)offsets.size() - 1; }
+    };
+    Bucket buckets[26];
+    std::string partial; // a line split between two chunks
+    bool sourceStart = true;
+    bool hasFrequencies = false;
+    unsigned int nextReport = 50000;
+
+    void addLine(const char* line, size_t length);
+
+public:
+    unsigned int accepted = 0;
+    unsigned int untypeable = 0;
+    unsigned int invalid = 0;
+    float levelCuts[2] = {}; // scores where levels 2 and 3 begin, set by pack()
+
+    void beginSource() { sourceStart = true; partial.clear(); }
+    void feed(const char* data, size_t size);
+    void endSource();
+
+    // one word per level at least; pack() can still leave a level empty when scores tie
+    bool hasThreeWords() const { return accepted >= 3; }
+    void pack(PackedWords* levels);
+    void clear();
+};
+
+// image written by DictionaryCompiler and looked for by loadDictionary()
+extern const char* dictionaryImageFile;
+
+// reads a whole word list into dictionary[] before returning
+bool parseDictionary(const char* filename = "ospd.txt");
+bool saveDictionaryImage(const char* filename);
+// maps an image and checks its checksum; false leaves the dictionary untouched
+bool loadDictionaryImage(const char* filename);
+// word lists for loadDictionary() to stream instead of ospd.txt; takes ownership
+void addWordSource(WordSource* source);
+// how pickRandomWord() weights words; set before loadDictionary()
+void setWordWeighting(const WordWeighting& weighting);
+const WordWeighting& getWordWeighting();
+// The image if there is a valid one (and no word sources were added),
+// otherwise streams the word sources on a background thread and returns as
+// soon as every level has a word. With EMBEDDED_DICTIONARY, the tables
+// compiled into the program.
+void loadDictionary();
+// blocks until a streaming load has finished, for runs that must repeat exactly
+void waitForDictionary();
+// the tables pickRandomWord() draws from right now
+const PackedWords* currentDictionary();
+
+#ifdef EMBEDDED_DICTIONARY
+// defined in DictionaryData.cpp, generated by DictionaryCompiler --emit-cpp
+extern const uint32_t embeddedBuckets[3][27];
+extern const uint32_t* const embeddedOffsets[3];
+extern const char* const embeddedWords[3];
+extern const float* const embeddedScores[3];
+extern const float* const embeddedFrequencies[3]; // NULL entries: no frequencies
+#endif
+
+StringView pickRandomWord(int level, Random& rng);
+
+#endif /* Dictionary_hpp */
@@ -0,0 +1,123 @@
+//
+//  DictionaryCompiler.cpp
+//  Mario Typer
+//
+//  Offline tool (its own target) that turns a word list into the binary
+//  dictionary image the game maps at startup: the level/letter buckets,
+//  offset tables, typing difficulty scores and word blobs laid out exactly
+//  as they are used, so the game does no parsing or scoring at all. Run it
+//  from the directory with ospd.txt whenever the word list changes.
+//
+//  With --emit-cpp it writes the same tables as a C++ source file of
+//  constexpr arrays instead. The kiosk target compiles that file in with
+//  EMBEDDED_DICTIONARY defined and needs no word list at run time.
+//
+//  Usage: DictionaryCompiler [--emit-cpp] [words.txt] [output]
+//         (defaults: ospd.txt, and ospd.dict or DictionaryData.cpp)
+//
+
+#import <stdio.h>
+#import <string.h>
+#import "Dictionary.hpp"
+
+// the three levels' tables as read-only arrays matching the declarations in Dictionary.hpp
+static bool emitSource(const char* input, const char* filename)
+{
+    FILE* file = fopen(filename, "w");
+    if(!file) {
+        printf("Could not write %s\n", filename);
+        return false;
+    }
+    fprintf(file, "//\n//  %s\n//  Mario Typer\n//\n", filename);
+    fprintf(file, "//  Generated by DictionaryCompiler --emit-cpp from %s. Do not edit.\n//\n\n", input);
+    fprintf(file, "#import \"Dictionary.hpp\"\n\n");
+
+    fprintf(file, "constexpr uint32_t embeddedBuckets[3][27] = {\n");
+    for(int level=0; level<3; level++) {
+        fprintf(file, "    {");
+        for(int i=0; i<27; i++)
+            fprintf(file, "%s%u", i ? ", " : " ", dictionary[level].getBuckets()[i]);
+        fprintf(file, " },\n");
+    }
+    fprintf(file, "};\n");
+
+    for(int level=0; level<3; level++) {
+        const PackedWords& words = dictionary[level];
+        fprintf(file, "\nstatic constexpr uint32_t offsets%d[%u] = {", level+1, words.count()+1);
+        for(unsigned int i=0; i<=words.count(); i++)
+            fprintf(file, "%s%u,", i % 16 == 0 ? "\n    " : " ", words.getOffsets() ? words.getOffsets()[i] : 0);
+        fprintf(file, "\n};\n");
+
+        fprintf(file, "\nstatic constexpr float scores%d[%u] = {", level+1, words.count() > 0 ? words.count() : 1);
+        for(unsigned int i=0; i<words.count(); i++)
+            fprintf(file, "%s%.9g,", i % 8 == 0 ? "\n    " : " ", words.getScores()[i]);
+        fprintf(file, "\n};\n");
+
+        if(words.getFrequencies()) {
+            fprintf(file, "\nstatic constexpr float frequencies%d[%u] = {", level+1, words.count() > 0 ? words.count() : 1);
+            for(unsigned int i=0; i<words.count(); i++)
+                fprintf(file, "%s%.9g,", i % 8 == 0 ? "\n    " : " ", words.getFrequencies()[i]);
+            fprintf(file, "\n};\n");
+        }
+
+        // the blob as string literals of 96 bytes; anything but a letter is
+        // written as an octal escape
+        fprintf(file, "\nstatic constexpr char words%d[] =", level+1);
+        size_t size = words.blobSize();
+        if(size == 0)
+            fprintf(file, " \"\"");
+        for(size_t at=0; at<size; at++) {
+            if(at % 96 == 0)
+                fprintf(file, "%s\n    \"", at ? "\"" : "");
+            unsigned char c = words.getBlob()[at];
+            if(c >= 'a' && c <= 'z')
+                fputc(c, file);
+            else
+                fprintf(file, "\\%03o", c);
+        }
+        fprintf(file, "%s;\n", size ? "\"" : "");
+    }
+
+    fprintf(file, "\nconstexpr const uint32_t* embeddedOffsets[3] = { offsets1, offsets2, offsets3 };\n");
+    fprintf(file, "constexpr const char* embeddedWords[3] = { words1, words2, words3 };\n");
+    fprintf(file, "constexpr const float* embeddedScores[3] = { scores1, scores2, scores3 };\n");
+    fprintf(file, "constexpr const float* embeddedFrequencies[3] = {");
+    for(int level=0; level<3; level++) {
+        if(dictionary[level].getFrequencies())
+            fprintf(file, "%s frequencies%d", level ? "," : "", level+1);
+        else
+            fprintf(file, "%s nullptr", level ? "," : "");
+    }
+    fprintf(file, " };\n");
+    bool ok = !ferror(file);
+    ok = fclose(file) == 0 && ok;
+    if(!ok)
+        printf("Could not write %s\n", filename);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    bool emitCpp = argc > 1 && strcmp(argv[1], "--emit-cpp") == 0;
+    int first = emitCpp ? 2 : 1;
+    const char* input = argc > first ? argv[first] : "ospd.txt";
+    const char* output = argc > first+1 ? argv[first+1] : emitCpp ? "DictionaryData.cpp" : dictionaryImageFile;
+
+    if(!parseDictionary(input))
+        return 1;
+    size_t parsed = dictionary[0].memoryUsed() + dictionary[1].memoryUsed() + dictionary[2].memoryUsed();
+
+    if(emitCpp) {
+        if(!emitSource(input, output))
+            return 1;
+        printf("Wrote %s (%d bytes of tables)\n", output, (int)parsed);
+        return 0;
+    }
+
+    if(!saveDictionaryImage(output))
+        return 1;
+    // read the image back the way the game will, so a bad one never ships
+    if(!loadDictionaryImage(output))
+        return 1;
+    printf("Wrote %s (%d bytes of tables)\n", output, (int)parsed);
+    return 0;
+}
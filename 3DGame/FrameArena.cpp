@@ -0,0 +1,62 @@
+//
+//  FrameArena.cpp
+//  Mario Typer
+//
+
+#import <stdarg.h>
+#import <stdio.h>
+#import <stdlib.h>
+#import <stdint.h>
+#import "FrameArena.hpp"
+
+ArenaAllocator::ArenaAllocator(size_t capacity):capacity(capacity)
+{
+    buffer = (unsigned char*)malloc(capacity);
+    if(buffer == NULL)
+        this->capacity = 0;
+}
+
+ArenaAllocator::~ArenaAllocator()
+{
+    reset();
+    free(buffer);
+}
+
+void* ArenaAllocator::allocate(size_t size, size_t alignment)
+{
+    uintptr_t start = ((uintptr_t)(buffer + used) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    size_t end = (start - (uintptr_t)buffer) + size;
+    if(end <= capacity) {
+        used = end;
+        if(used > highWater) highWater = used;
+        return (void*)start;
+    }
+    // out of space: still hand out memory, but from the heap, and say so once
+    if(overflow.empty())
+        printf("Frame arena of %d bytes is full, falling back to the heap\n", (int)capacity);
+    void* p = malloc(size);
+    overflow.push_back(p);
+    return p;
+}
+
+void ArenaAllocator::reset()
+{
+    for(void* p : overflow)
+        free(p);
+    overflow.clear();
+    used = 0;
+}
+
+const char* ArenaAllocator::format(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+    char* text = (char*)allocate(length > 0 ? length + 1 : 1, 1);
+    vsnprintf(text, length > 0 ? length + 1 : 1, fmt, copy);
+    va_end(copy);
+    return text;
+}
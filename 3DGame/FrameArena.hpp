@@ -0,0 +1,71 @@
+//
+//  FrameArena.hpp
+//  Mario Typer
+//
+//  Linear allocator for scratch memory that only lives for one simulation
+//  tick or one rendered frame. Allocating bumps a pointer into a block that
+//  was reserved once, and reset() frees everything at the same time, so
+//  per-tick temporaries never reach the general-purpose heap.
+//  ArenaString and ArenaVector are the standard containers on top of it.
+//
+
+#ifndef FrameArena_hpp
+#define FrameArena_hpp
+
+#import <stddef.h>
+#import <string>
+#import <vector>
+
+class ArenaAllocator
+{
+    unsigned char* buffer;
+    size_t capacity;
+    size_t used = 0;
+    size_t highWater = 0;
+    // allocations that did not fit; freed by the next reset()
+    std::vector<void*> overflow;
+
+public:
+    ArenaAllocator(size_t capacity);
+    ~ArenaAllocator();
+    ArenaAllocator(const ArenaAllocator&) = delete;
+    ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+    void* allocate(size_t size, size_t alignment = 16);
+    // frees everything allocated since the last reset
+    void reset();
+    // printf into the arena; the string lives until the next reset
+    const char* format(const char* fmt, ...);
+
+    size_t getUsed() const { return used; }
+    size_t getHighWater() const { return highWater; }
+    size_t getCapacity() const { return capacity; }
+};
+
+// std::allocator stand-in that takes memory from an ArenaAllocator and never frees
+template <typename T>
+class ArenaStlAllocator
+{
+public:
+    typedef T value_type;
+    ArenaAllocator* arena;
+
+    ArenaStlAllocator(ArenaAllocator& arena):arena(&arena) {}
+    template <typename U>
+    ArenaStlAllocator(const ArenaStlAllocator<U>& other):arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T* p, size_t n) {}
+
+    template <typename U>
+    bool operator==(const ArenaStlAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaStlAllocator<U>& other) const { return arena != other.arena; }
+};
+
+typedef std::basic_string<char, std::char_traits<char>, ArenaStlAllocator<char>> ArenaString;
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaStlAllocator<T>>;
+
+#endif /* FrameArena_hpp */
@@ -0,0 +1,106 @@
+//
+//  GpuTimers.cpp
+//  Mario Typer
+//
+
+#import <string.h>
+#import "GpuTimers.hpp"
+
+#ifndef HEADLESS
+
+#ifndef GL_TIME_ELAPSED_EXT
+#define GL_TIME_ELAPSED_EXT 0x88BF
+#endif
+
+const char* GpuTimers::passName(int pass)
+{
+    static const char* names[NUM_PASSES] = { "sky", "objects", "shadows", "hud" };
+    return names[pass];
+}
+
+bool GpuTimers::initialize()
+{
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    if(version) sscanf(version, "%d.%d", &major, &minor);
+    supported = (extensions && (strstr(extensions, "GL_EXT_timer_query") || strstr(extensions, "GL_ARB_timer_query")))
+                || major > 3 || (major == 3 && minor >= 3);
+    if(!supported) {
+        printf("GPU timer queries are not supported by this OpenGL driver\n");
+        return false;
+    }
+    glGenQueries(2*NUM_PASSES, &queries[0][0]);
+    for(int i=0; i<2; i++)
+        for(int pass=0; pass<NUM_PASSES; pass++)
+            issued[i][pass] = false;
+    for(int pass=0; pass<NUM_PASSES; pass++)
+        milliseconds[pass] = 0;
+    return true;
+}
+
+GpuTimers::~GpuTimers()
+{
+    if(log)
+        fclose(log);
+}
+
+bool GpuTimers::openLog(const char* filename)
+{
+    log = fopen(filename, "w");
+    if(!log)
+        return false;
+    fprintf(log, "frame");
+    for(int pass=0; pass<NUM_PASSES; pass++)
+        fprintf(log, ",%s_ms", passName(pass));
+    fprintf(log, "\n");
+    return true;
+}
+
+void GpuTimers::begin(Pass pass)
+{
+    if(!supported) return;
+    glBeginQuery(GL_TIME_ELAPSED_EXT, queries[current][pass]);
+}
+
+void GpuTimers::end(Pass pass)
+{
+    if(!supported) return;
+    glEndQuery(GL_TIME_ELAPSED_EXT);
+    issued[current][pass] = true;
+}
+
+void GpuTimers::endFrame()
+{
+    if(!supported) return;
+    frame++;
+    current = 1 - current;
+
+    // the set about to be reused was issued one frame ago; take whatever has finished
+    bool complete = true;
+    for(int pass=0; pass<NUM_PASSES; pass++) {
+        if(!issued[current][pass]) {
+            complete = false;
+            continue;
+        }
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[current][pass], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available) {
+            GLuint nanoseconds = 0;
+            glGetQueryObjectuiv(queries[current][pass], GL_QUERY_RESULT, &nanoseconds);
+            milliseconds[pass] = nanoseconds * 1e-6f;
+        } else {
+            complete = false;
+            skipped++;
+        }
+        issued[current][pass] = false;
+    }
+    if(log && complete) {
+        fprintf(log, "%u", frame - 2);
+        for(int pass=0; pass<NUM_PASSES; pass++)
+            fprintf(log, ",%.3f", milliseconds[pass]);
+        fprintf(log, "\n");
+    }
+}
+
+#endif // HEADLESS
@@ -0,0 +1,61 @@
+//
+//  GpuTimers.hpp
+//  Mario Typer
+//
+//  GPU time per render pass, from GL_TIME_ELAPSED timer queries. Queries are
+//  double-buffered: results of one frame are read back while the next frame
+//  is being issued, and only if the GPU has already finished them, so the
+//  CPU never waits on the GPU. Needs GL_EXT_timer_query (or GL 3.3).
+//
+
+#ifndef GpuTimers_hpp
+#define GpuTimers_hpp
+
+#import <stdio.h>
+#import "Platform.hpp"
+
+class GpuTimers
+{
+public:
+    enum Pass { SKY, OBJECTS, SHADOWS, HUD, NUM_PASSES };
+    static const char* passName(int pass);
+    
+private:
+    GLuint queries[2][NUM_PASSES];
+    bool issued[2][NUM_PASSES];
+    int current = 0; // query set of the frame being drawn
+    bool supported = false;
+    float milliseconds[NUM_PASSES]; // latest results
+    unsigned int frame = 0;
+    unsigned int skipped = 0; // results still pending when their queries had to be reused
+    FILE* log = NULL;
+    
+public:
+    // needs a current GL context; false if timer queries are unavailable
+    bool initialize();
+    ~GpuTimers();
+    // one CSV line per measured frame: frame and milliseconds per pass
+    bool openLog(const char* filename);
+    
+    void begin(Pass pass);
+    void end(Pass pass);
+    // after the buffer swap: collects last frame's results, if they are ready
+    void endFrame();
+    
+    bool isSupported() { return supported; }
+    float getMilliseconds(int pass) { return milliseconds[pass]; }
+    unsigned int getSkipped() { return skipped; }
+};
+
+// times the rest of the enclosing block; timers may be NULL
+class GpuTimerScope
+{
+    GpuTimers* timers;
+    GpuTimers::Pass pass;
+public:
+    GpuTimerScope(GpuTimers* timers, GpuTimers::Pass pass):timers(timers), pass(pass)
+    { if(timers) timers->begin(pass); }
+    ~GpuTimerScope() { if(timers) timers->end(pass); }
+};
+
+#endif /* GpuTimers_hpp */
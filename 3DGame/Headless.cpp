@@ -0,0 +1,387 @@
+//
+//  Headless.cpp
+//  Mario Typer
+//
+//  Entry point of the headless build (compiled with HEADLESS defined, no GL
+//  or GLUT). Plays whole games with synthetic or scripted keyboard input as
+//  fast as the CPU allows, for load tests, difficulty tuning and benchmarks.
+//
+//  Options:
+//    --games=N        number of games to play (default 100)
+//    --seed=N         batch seed; game i uses a seed derived from it (default: time)
+//    --threads=N      worker threads (default: one per hardware thread)
+//    --hz=N           simulation rate (default 60)
+//    --cps=N          typist speed in characters per second (default 6)
+//    --accuracy=F     fraction of correctly typed characters (default 0.95)
+//    --max-time=N     stop a game after N simulated seconds (default 600)
+//    --script=FILE    replay key taps from FILE instead of the typist
+//    --verbose        print the game's own log lines
+//    --any-lane       letters go to whichever lane's word they spell, no turning
+//    --lanes=N        stations around the player (default 4, up to 64)
+//    --waves=NAME     spawn by a wave schedule file or built-in preset (rush,
+//                     stress-1k, stress-4k) instead of the classic rules
+//    --record=FILE    play one game (game 1 of the batch) and save its input log
+//    --replay=FILE    replay an input log at full speed and check its final state
+//    --words=FILE     play with this word list instead of ospd.txt (repeatable)
+//    --word-weights=F,E,L  draw words in proportion to frequency^F * score^E * length^L
+//    --trace=FILE     write the profiled scopes as a Chrome trace (MARIO_PROFILE builds)
+//    --bench=NAME     run a micro-benchmark instead of games: compaction, sampling,
+//                     scoring
+//    --check-allocs   play one game and fail if steady-state steps allocate heap memory
+//
+
+#import <stdio.h>
+#import <stdlib.h>
+#import <string.h>
+#import <time.h>
+#import <chrono>
+#import "BatchRunner.hpp"
+#import "Dictionary.hpp"
+#import "InputLog.hpp"
+#import "Profiler.hpp"
+#import "Metrics.hpp"
+#import "ObjectPool.hpp"
+#import "SyntheticInput.hpp"
+#import "TypingDifficulty.hpp"
+
+// plays a single game with the batch's input source and saves its input log
+static int recordGame(const BatchOptions& options, const char* filename)
+{
+    Scene scene;
+    scene.setVerbose(options.verbose);
+    scene.setAnyLane(options.anyLane);
+    scene.setLaneCount(options.lanes);
+    scene.setWaves(options.waves);
+    scene.initialize();
+    InputSource* source;
+    if(options.script)
+        source = new InputScript(options.script);
+    else
+        source = new Typist(0, options.charsPerSecond, options.accuracy);
+    
+    unsigned int seed = BatchRunner::gameSeed(options.seed, 0);
+    float dt = 1/options.hz;
+    InputLog log;
+    scene.record(&log, seed, dt);
+    source->seed(seed);
+    InputQueue input;
+    long long maxSteps = (long long)(options.maxTime * options.hz);
+    for(long long i=0; i<maxSteps && !scene.isGameOver(); i++) {
+        source->control(dt, scene, input);
+        scene.control(dt, input);
+    }
+    scene.stopRecording();
+    delete source;
+    
+    if(!log.save(filename)) {
+        printf("Could not write input log %s\n", filename);
+        return 1;
+    }
+    printf("Recorded %u steps, %u key events (survived %.1f s) to %s\n",
+           log.steps, (unsigned int)log.events.size(), scene.getStats().survivalTime, filename);
+    return 0;
+}
+
+// replays an input log as fast as possible; fails if the final state differs
+static int replayGame(const InputLog& log, bool verbose)
+{
+    Scene scene;
+    scene.setVerbose(verbose);
+    scene.applyLogSettings(log); // before initialize(), which sizes the pools for them
+    scene.initialize();
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    scene.replay(&log);
+    InputQueue input;
+    while(!scene.replayFinished())
+        scene.control(log.stepSize, input);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    GameStats stats = scene.getStats();
+    uint64_t hash = scene.stateHash();
+    printf("Replayed %u steps in %.3f s (%.0f steps/s): survived %.1f s, %d words, %d kills\n",
+           log.steps, wall, log.steps/(wall > 0 ? wall : 1e-9), stats.survivalTime, stats.wordsTyped, stats.enemiesKilled);
+    if(hash != log.finalHash) {
+        printf("Replay diverged: final state %016llx, recorded %016llx\n",
+               (unsigned long long)hash, (unsigned long long)log.finalHash);
+        return 1;
+    }
+    printf("Final state matches recording (%016llx)\n", (unsigned long long)hash);
+    return 0;
+}
+
+// bare object for benchmarks, nothing to draw
+class BenchObject : public Object
+{
+public:
+    BenchObject():Object(NULL, ENEMY) {}
+    void drawModel() {}
+    void drawShadow(float3 lightDir, float3 groundNormal, float3 groundPosition, float alpha) {}
+};
+
+// A burst of 1000 kills in one tick among 1000 survivors: erasing each dead
+// object from the middle of the vector, as Scene used to, against one
+// swap-and-pop pass.
+static int benchCompaction()
+{
+    const int kills = 1000;
+    const int rounds = 200;
+    std::vector<Object*> all;
+    for(int i=0; i<2*kills; i++) {
+        Object* object = new BenchObject();
+        if(i % 2 == 0) object->kill();
+        all.push_back(object);
+    }
+    
+    double eraseTime = 0, compactTime = 0;
+    for(int round=0; round<rounds; round++) {
+        std::vector<Object*> objects = all;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(std::vector<Object*>::iterator it=objects.begin(); it!=objects.end(); ) {
+            if((*it)->isDead()) it = objects.erase(it);
+            else ++it;
+        }
+        eraseTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        objects = all;
+        start = std::chrono::steady_clock::now();
+        swapAndPop(objects, [](Object* object) { return object->isDead(); });
+        compactTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if(objects.size() != kills) {
+            printf("swapAndPop kept %d objects, expected %d\n", (int)objects.size(), kills);
+            return 1;
+        }
+    }
+    for(Object* object : all)
+        delete object;
+    
+    printf("Removing %d dead of %d objects, %d rounds:\n", kills, 2*kills, rounds);
+    printf("  erase in place  %8.1f us per burst\n", eraseTime / rounds * 1e6);
+    printf("  swap and pop    %8.1f us per burst (%.0fx faster)\n", compactTime / rounds * 1e6, eraseTime / compactTime);
+    return 0;
+}
+
+// Draws words from the level 2 table (the largest) the way pickRandomWord
+// used to, by letter and then by word, against one uniform draw over the
+// level and against an alias table weighted by typing difficulty. The share of
+// q/x/z words shows the bias of drawing a letter first.
+static int benchSampling()
+{
+    const int samples = 10000000;
+    const PackedWords& words = currentDictionary()[1];
+    if(words.count() == 0) {
+        printf("No level 2 words to sample\n");
+        return 1;
+    }
+    unsigned int rare = 0;
+    for(int letter : { 'q'-'a', 'x'-'a', 'z'-'a' })
+        rare += words.bucketSize(letter);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<double> weights(words.count());
+    for(unsigned int n=0; n<words.count(); n++)
+        weights[n] = words.score(n);
+    AliasTable table;
+    table.build(weights);
+    double buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Sampling %d words from %u (%.2f%% start with q, x or z); alias table built in %.2f ms:\n",
+           samples, words.count(), 100.0*rare/words.count(), buildTime*1000);
+    for(int method=0; method<3; method++) {
+        Random rng(42);
+        unsigned int checksum = 0, rareDrawn = 0;
+        start = std::chrono::steady_clock::now();
+        for(int i=0; i<samples; i++) {
+            StringView word;
+            if(method == 0) {
+                int letter = rng.range(0, 25);
+                word = words.word(letter, rng.range(0, (int)words.bucketSize(letter)-1));
+            } else if(method == 1) {
+                word = words.word(rng.below(words.count()));
+            } else {
+                word = words.word(table.sample(rng));
+            }
+            checksum += word.length;
+            rareDrawn += word.data[0] == 'q' || word.data[0] == 'x' || word.data[0] == 'z';
+        }
+        double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        static const char* names[3] = { "letter, then word", "uniform over level", "alias, by score" };
+        printf("  %-20s %7.1f M samples/s, %5.2f%% q/x/z (checksum %u)\n",
+               names[method], samples / time * 1e-6, 100.0*rareDrawn/samples, checksum);
+    }
+    return 0;
+}
+
+// Scores every word of the loaded dictionary again, straight from the packed
+// blobs, and checks the result against the scores stored with the words.
+static int benchScoring()
+{
+    const int rounds = 20;
+    const PackedWords* levels = currentDictionary();
+    unsigned int total = levels[0].count() + levels[1].count() + levels[2].count();
+    std::vector<float> scores[3];
+    for(int level=0; level<3; level++)
+        scores[level].resize(levels[level].count());
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int round=0; round<rounds; round++)
+        for(int level=0; level<3; level++)
+            scoreWords(levels[level].getBlob(), levels[level].getOffsets(), levels[level].count(), scores[level].data());
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / rounds;
+
+    unsigned int mismatches = 0;
+    for(int level=0; level<3; level++)
+        for(unsigned int n=0; n<levels[level].count(); n++)
+            mismatches += scores[level][n] != levels[level].score(n);
+    printf("Scored %u words in %.2f ms (%.1f M words/s), %u differ from the stored scores\n",
+           total, time*1000, total / time * 1e-6, mismatches);
+    return mismatches ? 1 : 0;
+}
+
+// Plays one game with the batch's typist and counts heap allocations (through
+// the counting operator new in Metrics.cpp) made by the simulation once it
+// has warmed up. Steady-state play is expected not to allocate at all.
+static int checkAllocations(const BatchOptions& options)
+{
+    Scene scene;
+    scene.setVerbose(false);
+    scene.setAnyLane(options.anyLane);
+    scene.setLaneCount(options.lanes);
+    scene.setWaves(options.waves);
+    scene.initialize();
+    Typist typist(BatchRunner::gameSeed(options.seed, 0), options.charsPerSecond, options.accuracy);
+    scene.seed(BatchRunner::gameSeed(options.seed, 0));
+    scene.reset();
+    InputQueue input;
+    float dt = 1/options.hz;
+    
+    // the first seconds fill containers to their working size
+    long long warmupSteps = (long long)(10 * options.hz);
+    long long maxSteps = (long long)(options.maxTime * options.hz);
+    long long steps = 0, measured = 0;
+    long long allocations = 0;
+    long long firstAllocationStep = -1;
+    while(!scene.isGameOver() && steps < maxSteps) {
+        long long before = Metrics::current(Metrics::ALLOCATIONS);
+        typist.control(dt, scene, input);
+        scene.control(dt, input);
+        long long made = Metrics::current(Metrics::ALLOCATIONS) - before;
+        if(steps >= warmupSteps) {
+            measured++;
+            allocations += made;
+            if(made > 0 && firstAllocationStep < 0)
+                firstAllocationStep = steps;
+        }
+        steps++;
+    }
+    
+    printf("%lld heap allocations in %lld steady-state steps (%.1f s of play after a %.0f s warm-up)\n",
+           allocations, measured, measured / options.hz, warmupSteps / options.hz);
+    if(allocations > 0) {
+        printf("First one at step %lld (%.2f s)\n", firstAllocationStep, firstAllocationStep / options.hz);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    
+    BatchOptions options;
+    options.seed = (unsigned int)time(NULL);
+    const char* recordFile = NULL;
+    const char* replayFile = NULL;
+    const char* traceFile = NULL;
+    const char* bench = NULL;
+    bool checkAllocs = false;
+    WordWeighting weighting;
+    
+    for(int i=1; i<argc; i++) {
+        if(sscanf(argv[i], "--games=%d", &options.games) == 1) continue;
+        if(sscanf(argv[i], "--seed=%u", &options.seed) == 1) continue;
+        if(sscanf(argv[i], "--threads=%d", &options.threads) == 1) continue;
+        if(sscanf(argv[i], "--hz=%f", &options.hz) == 1) continue;
+        if(sscanf(argv[i], "--cps=%f", &options.charsPerSecond) == 1) continue;
+        if(sscanf(argv[i], "--accuracy=%f", &options.accuracy) == 1) continue;
+        if(sscanf(argv[i], "--max-time=%f", &options.maxTime) == 1) continue;
+        if(strncmp(argv[i], "--script=", 9) == 0) { options.script = argv[i] + 9; continue; }
+        if(strcmp(argv[i], "--verbose") == 0) { options.verbose = true; continue; }
+        if(strcmp(argv[i], "--any-lane") == 0) { options.anyLane = true; continue; }
+        if(sscanf(argv[i], "--lanes=%d", &options.lanes) == 1) continue;
+        if(strncmp(argv[i], "--waves=", 8) == 0) {
+            if(!options.waves.load(argv[i] + 8))
+                return 1;
+            continue;
+        }
+        if(strncmp(argv[i], "--record=", 9) == 0) { recordFile = argv[i] + 9; continue; }
+        if(strncmp(argv[i], "--replay=", 9) == 0) { replayFile = argv[i] + 9; continue; }
+        if(strncmp(argv[i], "--trace=", 8) == 0) { traceFile = argv[i] + 8; continue; }
+        if(strncmp(argv[i], "--words=", 8) == 0) { addWordSource(new FileWordSource(argv[i] + 8)); continue; }
+        if(sscanf(argv[i], "--word-weights=%f,%f,%f", &weighting.frequencyExponent, &weighting.difficultyExponent, &weighting.lengthExponent) == 3) {
+            setWordWeighting(weighting);
+            continue;
+        }
+        if(strncmp(argv[i], "--bench=", 8) == 0) { bench = argv[i] + 8; continue; }
+        if(strcmp(argv[i], "--check-allocs") == 0) { checkAllocs = true; continue; }
+        printf("Unknown option %s\n", argv[i]);
+        return 1;
+    }
+    
+    // a missing or empty script would play every game without any input
+    if(options.script && !InputScript(options.script).isLoaded()) {
+        printf("No key taps in script %s\n", options.script);
+        return 1;
+    }
+    
+    if(bench) {
+        if(strcmp(bench, "compaction") == 0)
+            return benchCompaction();
+        if(strcmp(bench, "sampling") == 0) {
+            loadDictionary();
+            waitForDictionary();
+            return benchSampling();
+        }
+        if(strcmp(bench, "scoring") == 0) {
+            loadDictionary();
+            waitForDictionary();
+            return benchScoring();
+        }
+        printf("Unknown benchmark %s\n", bench);
+        return 1;
+    }
+    
+    // a recording draws its words with the weighting it was made with
+    InputLog replayLog;
+    if(replayFile) {
+        if(!replayLog.load(replayFile)) {
+            printf("Could not read input log %s\n", replayFile);
+            return 1;
+        }
+        setWordWeighting(replayLog.wordWeighting);
+    }
+    
+    srand(options.seed);
+    loadDictionary();
+    // results only repeat if every game draws from the complete list
+    waitForDictionary();
+    
+    int result = 0;
+    if(checkAllocs) {
+        result = checkAllocations(options);
+    } else if(replayFile) {
+        result = replayGame(replayLog, options.verbose);
+    } else if(recordFile) {
+        result = recordGame(options, recordFile);
+    } else {
+        printf("Playing %d games (seed %u, %.0f Hz)...\n", options.games, options.seed, options.hz);
+        BatchRunner runner(options);
+        BatchSummary summary = runner.run();
+        printSummary(summary, options.hz);
+        printf("Spawned %lld objects, erased %lld, %lld heap allocations (%lld bytes)\n",
+               Metrics::current(Metrics::SPAWNS), Metrics::current(Metrics::ERASES),
+               Metrics::current(Metrics::ALLOCATIONS), Metrics::current(Metrics::ALLOCATED_BYTES));
+    }
+    
+    if(traceFile)
+        Profiler::exportTrace(traceFile);
+    return result;
+}
@@ -0,0 +1,157 @@
+//
+//  InputLog.cpp
+//  Mario Typer
+//
+
+#import <stdio.h>
+#import <string.h>
+#import "InputLog.hpp"
+
+static const char magic[4] = { 'M', 'T', 'I', 'L' };
+// bumped whenever the layout or the meaning of the events changes, so old
+// logs are refused on load instead of failing the final state check:
+//   1 transitions of the key state array as polled at each step
+//   2 typing mode flags, 3 station count, 4 wave schedule text
+//   5 events are the press/release transitions of the timestamped input queue
+//   6 word weighting exponents
+static const uint8_t version = 6;
+
+static void putBytes(std::vector<uint8_t>& out, uint64_t value, int count)
+{
+    for(int i=0; i<count; i++)
+        out.push_back((uint8_t)(value >> (8*i)));
+}
+
+static void putFloat(std::vector<uint8_t>& out, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, 4);
+    putBytes(out, bits, 4);
+}
+
+static void putVarint(std::vector<uint8_t>& out, uint32_t value)
+{
+    while(value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+static bool getBytes(const std::vector<uint8_t>& in, size_t& pos, uint64_t& value, int count)
+{
+    if(pos + count > in.size()) return false;
+    value = 0;
+    for(int i=0; i<count; i++)
+        value |= (uint64_t)in[pos++] << (8*i);
+    return true;
+}
+
+static bool getFloat(const std::vector<uint8_t>& in, size_t& pos, float& value)
+{
+    uint64_t bits;
+    if(!getBytes(in, pos, bits, 4)) return false;
+    uint32_t word = (uint32_t)bits;
+    memcpy(&value, &word, 4);
+    return true;
+}
+
+static bool getVarint(const std::vector<uint8_t>& in, size_t& pos, uint32_t& value)
+{
+    value = 0;
+    for(int shift=0; shift<35; shift+=7) {
+        if(pos >= in.size()) return false;
+        uint8_t byte = in[pos++];
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if(!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool InputLog::save(const char* filename)
+{
+    std::vector<uint8_t> out(magic, magic + 4);
+    out.push_back(version);
+    putBytes(out, seed, 8);
+    putFloat(out, stepSize);
+    putBytes(out, steps, 4);
+    putBytes(out, finalHash, 8);
+    out.push_back(anyLane ? 1 : 0);
+    out.push_back((uint8_t)lanes);
+    putFloat(out, wordWeighting.frequencyExponent);
+    putFloat(out, wordWeighting.difficultyExponent);
+    putFloat(out, wordWeighting.lengthExponent);
+    putBytes(out, waves.size(), 4);
+    out.insert(out.end(), waves.begin(), waves.end());
+    putBytes(out, events.size(), 4);
+    uint32_t lastStep = 0;
+    for(const Event& event : events) {
+        putVarint(out, event.step - lastStep);
+        putVarint(out, ((uint32_t)event.key << 1) | (event.down ? 1 : 0));
+        lastStep = event.step;
+    }
+    
+    FILE* file = fopen(filename, "wb");
+    if(!file) {
+        printf("Could not write input log %s\n", filename);
+        return false;
+    }
+    bool ok = fwrite(out.data(), 1, out.size(), file) == out.size();
+    fclose(file);
+    return ok;
+}
+
+bool InputLog::load(const char* filename)
+{
+    FILE* file = fopen(filename, "rb");
+    if(!file) {
+        printf("file %s not found\n", filename);
+        return false;
+    }
+    std::vector<uint8_t> in;
+    uint8_t buffer[4096];
+    size_t n;
+    while((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        in.insert(in.end(), buffer, buffer + n);
+    fclose(file);
+    
+    size_t pos = 5;
+    uint64_t value = 0;
+    if(in.size() < pos || memcmp(in.data(), magic, 4) != 0 || in[4] != version) {
+        printf("%s is not an input log (or has the wrong version)\n", filename);
+        return false;
+    }
+    bool ok = getBytes(in, pos, seed, 8);
+    ok = ok && getFloat(in, pos, stepSize);
+    ok = ok && getBytes(in, pos, value, 4);
+    steps = (uint32_t)value;
+    ok = ok && getBytes(in, pos, finalHash, 8);
+    ok = ok && getBytes(in, pos, value, 1);
+    anyLane = (value & 1) != 0;
+    ok = ok && getBytes(in, pos, value, 1);
+    lanes = (int)value;
+    ok = ok && getFloat(in, pos, wordWeighting.frequencyExponent);
+    ok = ok && getFloat(in, pos, wordWeighting.difficultyExponent);
+    ok = ok && getFloat(in, pos, wordWeighting.lengthExponent);
+    ok = ok && getBytes(in, pos, value, 4) && pos + value <= in.size();
+    if(ok) {
+        waves.assign(in.begin() + pos, in.begin() + pos + value);
+        pos += value;
+    }
+    ok = ok && getBytes(in, pos, value, 4);
+    uint32_t count = (uint32_t)value;
+    
+    events.clear();
+    uint32_t step = 0;
+    for(uint32_t i=0; ok && i<count; i++) {
+        uint32_t delta = 0, code = 0;
+        ok = getVarint(in, pos, delta) && getVarint(in, pos, code);
+        if(!ok) break;
+        step += delta;
+        Event event = { step, (uint16_t)(code >> 1), (code & 1) != 0 };
+        events.push_back(event);
+    }
+    if(!ok)
+        printf("Input log %s is truncated\n", filename);
+    return ok;
+}
@@ -0,0 +1,50 @@
+//
+//  InputLog.hpp
+//  Mario Typer
+//
+//  Recorded input session: the seed and step size a Scene ran with, plus
+//  every key transition and the simulation step it happened on. Replaying
+//  it through the same build reproduces the session bit for bit, which
+//  makes a real player's game a repeatable benchmark workload.
+//
+//  File layout (little endian):
+//    "MTIL" u8 version  u64 seed  f32 stepSize  u32 steps  u64 finalHash  u8 flags  u8 lanes
+//    f32 frequencyExponent  f32 difficultyExponent  f32 lengthExponent
+//    u32 wavesLength  wavesLength bytes of wave schedule text  u32 eventCount
+//    flags: bit 0 typing at any lane
+//    per event: varint(step delta)  varint(key << 1 | down)
+//
+
+#ifndef InputLog_hpp
+#define InputLog_hpp
+
+#import <stdint.h>
+#import <string>
+#import <vector>
+#import "Dictionary.hpp"
+
+class InputLog
+{
+public:
+    struct Event
+    {
+        uint32_t step;
+        uint16_t key;
+        bool down;
+    };
+    
+    uint64_t seed = 0;
+    float stepSize = 1.0f/60;
+    uint32_t steps = 0;      // length of the session in simulation steps
+    uint64_t finalHash = 0;  // Scene::stateHash() after the last step
+    bool anyLane = false;    // the Scene's typing mode, which changes what keys do
+    int lanes = 4;           // stations around the avatar
+    std::string waves;       // the wave schedule's text, empty for classic spawning
+    WordWeighting wordWeighting; // how words were drawn; set it before the dictionary loads
+    std::vector<Event> events;
+    
+    bool save(const char* filename);
+    bool load(const char* filename);
+};
+
+#endif /* InputLog_hpp */
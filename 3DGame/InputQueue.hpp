@@ -0,0 +1,77 @@
+//
+//  InputQueue.hpp
+//  Mario Typer
+//
+//  Keyboard events on their way from the window to the simulation. The GLUT
+//  callbacks (or a synthetic input source) push every key press and release
+//  with the time it happened; Scene::control drains them in order, so a key
+//  tapped twice between two simulation steps still counts twice.
+//
+
+#ifndef InputQueue_hpp
+#define InputQueue_hpp
+
+#import <stdint.h>
+#import <atomic>
+
+struct KeyEvent
+{
+    double time;  // seconds, on the clock of whoever pushed the event
+    uint16_t key; // keysPressed index: a character or a SpecialKey
+    bool down;
+};
+
+// Lock-free ring buffer for exactly one producer and one consumer thread.
+// Capacity must be a power of two; one slot stays empty to tell full from empty.
+template <typename T, unsigned int Capacity>
+class SpscRing
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    T items[Capacity];
+    std::atomic<unsigned int> head; // next slot to read, written by the consumer
+    std::atomic<unsigned int> tail; // next slot to write, written by the producer
+public:
+    SpscRing():head(0), tail(0) {}
+
+    // producer side; returns false (and drops item) when full
+    bool push(const T& item)
+    {
+        unsigned int t = tail.load(std::memory_order_relaxed);
+        unsigned int next = (t + 1) & (Capacity - 1);
+        if(next == head.load(std::memory_order_acquire))
+            return false;
+        items[t] = item;
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side; the oldest item, without removing it
+    bool peek(T& item)
+    {
+        unsigned int h = head.load(std::memory_order_relaxed);
+        if(h == tail.load(std::memory_order_acquire))
+            return false;
+        item = items[h];
+        return true;
+    }
+
+    // consumer side; removes the oldest item
+    bool pop(T& item)
+    {
+        if(!peek(item))
+            return false;
+        head.store((head.load(std::memory_order_relaxed) + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool empty()
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+// a few seconds of frantic typing, even if the simulation stalls
+typedef SpscRing<KeyEvent, 256> InputQueue;
+
+#endif /* InputQueue_hpp */
@@ -0,0 +1,46 @@
+//
+//  Lanes.cpp
+//  Mario Typer
+//
+
+#define _USE_MATH_DEFINES
+#import <math.h>
+#import "Lanes.hpp"
+#import "Object.hpp"
+
+float laneAngle(int lane, int laneCount)
+{
+    return 2*M_PI*lane / laneCount;
+}
+
+void LaneIndex::setLaneCount(int lanes, unsigned int maxEnemies)
+{
+    enemies.assign(maxEnemies, NULL);
+    starts.assign(lanes + 1, 0);
+    filled.assign(lanes, 0);
+    avatar = NULL;
+}
+
+void LaneIndex::rebuild(const std::vector<Object*>& objects)
+{
+    // counting sort: sizes, then where each lane starts, then fill in
+    int lanes = laneCount();
+    starts.assign(lanes + 1, 0);
+    avatar = NULL;
+    for(Object* object : objects) {
+        if(object->type == Object::ENEMY) {
+            // only Enemy objects are ever created with type ENEMY
+            starts[static_cast<Enemy*>(object)->getPosition() + 1]++;
+            object->setColliding(false);
+        } else if(object->type == Object::AVATAR) {
+            avatar = object;
+        }
+    }
+    for(int lane=0; lane<lanes; lane++) {
+        starts[lane+1] += starts[lane];
+        filled[lane] = starts[lane];
+    }
+    for(Object* object : objects)
+        if(object->type == Object::ENEMY)
+            enemies[filled[static_cast<Enemy*>(object)->getPosition()]++] = object;
+}
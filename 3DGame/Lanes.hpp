@@ -0,0 +1,49 @@
+//
+//  Lanes.hpp
+//  Mario Typer
+//
+//  The stations around the player. There are any number of them, spread
+//  evenly on a circle, and each one is a lane: its enemies come down it and
+//  fireballs typed at its word fly up it. LaneIndex sorts the enemies by
+//  lane once per tick. A fireball then only tests the enemies of its own
+//  lane, and nothing has to search the whole object list, so the cost of a
+//  tick grows with the number of objects and not with its square.
+//
+
+#ifndef Lanes_hpp
+#define Lanes_hpp
+
+#import <stdint.h>
+#import <vector>
+
+class Object;
+
+const int maxLanes = 64;
+
+// direction of a station from the player: radians from +z towards +x
+float laneAngle(int lane, int laneCount);
+
+class LaneIndex
+{
+    std::vector<Object*> enemies;  // grouped by lane, in object order within a lane
+    std::vector<uint32_t> starts;  // lane i holds enemies[starts[i]] up to enemies[starts[i+1]]
+    std::vector<uint32_t> filled;  // scratch for rebuild()
+    Object* avatar = NULL;
+
+public:
+    // sized once for up to maxEnemies enemies, so rebuild() never allocates
+    void setLaneCount(int lanes, unsigned int maxEnemies);
+    // also clears the enemies' collision flags, which fireballs and the avatar set again
+    void rebuild(const std::vector<Object*>& objects);
+
+    int laneCount() const { return (int)starts.size() - 1; }
+    Object* getAvatar() const { return avatar; }
+    Object* const* begin(int lane) const { return enemies.data() + starts[lane]; }
+    Object* const* end(int lane) const { return enemies.data() + starts[lane+1]; }
+    // the most recently spawned enemy of a lane, NULL if it has none
+    Object* newest(int lane) const { return starts[lane+1] > starts[lane] ? enemies[starts[lane+1]-1] : NULL; }
+    Object* const* beginAll() const { return enemies.data(); }
+    Object* const* endAll() const { return enemies.data() + starts.back(); }
+};
+
+#endif /* Lanes_hpp */
@@ -0,0 +1,86 @@
+//
+//  Latency.cpp
+//  Mario Typer
+//
+
+#import <stdio.h>
+#import <string.h>
+#import <algorithm>
+#import "Latency.hpp"
+#import "Timestep.hpp"
+
+int LatencyTracker::consumed(int key, double delivered)
+{
+    Sample sample = { key, delivered, monotonicSeconds(), -1, -1 };
+    samples.push_back(sample);
+    return (int)samples.size() - 1;
+}
+
+void LatencyTracker::spawned(int sample)
+{
+    samples.at(sample).spawned = monotonicSeconds();
+}
+
+void LatencyTracker::frameSwapped()
+{
+    double now = monotonicSeconds();
+    for(unsigned int i=firstUnswapped; i<samples.size(); i++) {
+        if(samples[i].spawned >= 0)
+            samples[i].swapped = now;
+    }
+    firstUnswapped = (unsigned int)samples.size();
+}
+
+static void printPercentiles(const char* name, std::vector<double>& ms)
+{
+    if(ms.size() == 0) {
+        printf("  %-18s no samples\n", name);
+        return;
+    }
+    std::sort(ms.begin(), ms.end());
+    size_t n = ms.size();
+    printf("  %-18s p50 %6.2f ms  p95 %6.2f ms  p99 %6.2f ms  max %6.2f ms  (%d samples)\n", name,
+           ms[n/2], ms[std::min(n-1, n*95/100)], ms[std::min(n-1, n*99/100)], ms[n-1], (int)n);
+}
+
+void LatencyTracker::printSummary()
+{
+    std::vector<double> consume, spawn, photon;
+    for(const Sample& sample : samples) {
+        consume.push_back((sample.consumed - sample.delivered) * 1000);
+        if(sample.spawned >= 0)
+            spawn.push_back((sample.spawned - sample.delivered) * 1000);
+        if(sample.swapped >= 0)
+            photon.push_back((sample.swapped - sample.delivered) * 1000);
+    }
+    printf("Keystroke latency over %d keystrokes:\n", (int)samples.size());
+    printPercentiles("key to consume", consume);
+    printPercentiles("key to fireball", spawn);
+    printPercentiles("key to swap", photon);
+}
+
+bool LatencyTracker::save(const char* filename)
+{
+    FILE* file = fopen(filename, "w");
+    if(!file)
+        return false;
+    const char* extension = strrchr(filename, '.');
+    bool json = extension && strcmp(extension, ".json") == 0;
+
+    if(json)
+        fprintf(file, "[\n");
+    else
+        fprintf(file, "key,delivered,consumed,spawned,swapped\n");
+    for(unsigned int i=0; i<samples.size(); i++) {
+        const Sample& s = samples[i];
+        if(json)
+            fprintf(file, "  {\"key\": %d, \"delivered\": %.6f, \"consumed\": %.6f, \"spawned\": %.6f, \"swapped\": %.6f}%s\n",
+                    s.key, s.delivered, s.consumed, s.spawned, s.swapped, i+1 < samples.size() ? "," : "");
+        else
+            fprintf(file, "%d,%.6f,%.6f,%.6f,%.6f\n", s.key, s.delivered, s.consumed, s.spawned, s.swapped);
+    }
+    if(json)
+        fprintf(file, "]\n");
+    fclose(file);
+    return true;
+}
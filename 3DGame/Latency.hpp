@@ -0,0 +1,50 @@
+//
+//  Latency.hpp
+//  Mario Typer
+//
+//  Keystroke-to-fireball latency. Every typed letter is followed from the
+//  moment GLUT delivered it, to when the simulation consumed it, to when its
+//  fireball was spawned, to the buffer swap of the first frame that shows
+//  the fireball. A session's samples can be summarized as percentiles and
+//  exported as CSV or JSON.
+//
+
+#ifndef Latency_hpp
+#define Latency_hpp
+
+#import <vector>
+
+class LatencyTracker
+{
+public:
+    // times in seconds on the monotonicSeconds() clock, -1 if it never happened
+    struct Sample
+    {
+        int key;
+        double delivered;
+        double consumed;
+        double spawned;  // the key fired a projectile
+        double swapped;  // first swap after the spawn
+    };
+    
+private:
+    std::vector<Sample> samples;
+    unsigned int firstUnswapped = 0; // samples before this one are complete
+    
+public:
+    LatencyTracker() { samples.reserve(4096); }
+    
+    // a key press reached handleTyping; returns the sample index for spawned()
+    int consumed(int key, double delivered);
+    void spawned(int sample);
+    // the frame just swapped in shows everything spawned so far
+    void frameSwapped();
+    
+    const std::vector<Sample>& getSamples() { return samples; }
+    // p50/p95/p99 of each stage, measured from delivery
+    void printSummary();
+    // format chosen by extension: .json or anything else for CSV
+    bool save(const char* filename);
+};
+
+#endif /* Latency_hpp */
@@ -10,6 +10,7 @@
 
 void DirectionalLight::apply( GLenum openglLightName )
 {
+#ifndef HEADLESS
     float aglPos[] = {dir.x, dir.y, dir.z, 0.0f};
     glLightfv(openglLightName, GL_POSITION, aglPos);
     float aglZero[] = {0.0f, 0.0f, 0.0f, 0.0f};
@@ -20,9 +21,11 @@ void DirectionalLight::apply( GLenum openglLightName )
     glLightf(openglLightName, GL_CONSTANT_ATTENUATION, 1.0f);
     glLightf(openglLightName, GL_LINEAR_ATTENUATION, 0.0f);
     glLightf(openglLightName, GL_QUADRATIC_ATTENUATION, 0.0f);
+#endif
 }
 
 void PointLight::apply(GLenum openglLightName) {
+#ifndef HEADLESS
     float aglPos[] = {pos.x, pos.y, pos.z, 1.0f};
     glLightfv(openglLightName, GL_POSITION, aglPos);
     float aglZero[] = {0.0f, 0.0f, 0.0f, 0.0f};
@@ -33,4 +36,5 @@ void PointLight::apply(GLenum openglLightName) {
     glLightf(openglLightName, GL_CONSTANT_ATTENUATION, 0.0f);
     glLightf(openglLightName, GL_LINEAR_ATTENUATION, 0.0f);
     glLightf(openglLightName, GL_QUADRATIC_ATTENUATION, 0.25f / 3.14f);
+#endif
 }
\ No newline at end of file
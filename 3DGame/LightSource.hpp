@@ -10,9 +10,7 @@
 #define LightSource_hpp
 
 #import <stdio.h>
-#import <OpenGL/gl.h>
-#import <OpenGL/glu.h>
-#import <GLUT/glut.h>
+#import "Platform.hpp"
 #import "float3.h"
 
 class LightSource
@@ -7,9 +7,12 @@
 //
 
 #import "Material.hpp"
+#import "Metrics.hpp"
 
 void Material::apply()
 {
+#ifndef HEADLESS
+    Metrics::add(Metrics::MATERIAL_APPLIES);
     glDisable(GL_TEXTURE_2D);
     float aglDiffuse[] = {kd.x, kd.y, kd.z, 1.0f};
     glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, aglDiffuse);
@@ -19,11 +22,13 @@ void Material::apply()
         glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, shininess);
     else
         glMaterialf(GL_FRONT_AND_BACK, GL_SHININESS, 128.0f);
+#endif
 }
 
 TexturedMaterial::TexturedMaterial(const char* filename, GLint filtering)
 {
     this->filtering = filtering;
+#ifndef HEADLESS
     unsigned char* data;
     int width;
     int height;
@@ -39,17 +44,21 @@ TexturedMaterial::TexturedMaterial(const char* filename, GLint filtering)
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0,
                      GL_RGB, GL_UNSIGNED_BYTE, data); // uploading
     delete data;
+#endif
 }
 
 void TexturedMaterial::apply()
 {
+#ifndef HEADLESS
     Material::apply();
     glEnable(GL_TEXTURE_2D);
     glBindTexture(GL_TEXTURE_2D, textureName);
+    Metrics::add(Metrics::TEXTURE_BINDS);
     glTexParameteri(GL_TEXTURE_2D,
                     GL_TEXTURE_MIN_FILTER, filtering);
     glTexParameteri(GL_TEXTURE_2D,
                     GL_TEXTURE_MAG_FILTER, filtering);
     glTexEnvi(GL_TEXTURE_ENV,
               GL_TEXTURE_ENV_MODE, GL_REPLACE);
+#endif
 }
\ No newline at end of file
@@ -10,9 +10,7 @@
 #define Material_hpp
 
 #import <stdio.h>
-#import <OpenGL/gl.h>
-#import <OpenGL/glu.h>
-#import <GLUT/glut.h>
+#import "Platform.hpp"
 #import "float3.h"
 
 extern "C" unsigned char* stbi_load(char const *filename, int *x, int *y, int
@@ -9,17 +9,9 @@
 #include <fstream>
 #include <algorithm>
 
-#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
-// Needed on MsWindows
-#include <windows.h>
-#endif // Win32 platform
-
-#import <OpenGL/gl.h>
-#import <OpenGL/glu.h>
-// Download glut from: http://www.opengl.org/resources/libraries/glut/
-#import <GLUT/glut.h>
-
+#import "Platform.hpp"
 #import "Mesh.hpp"
+#import "Metrics.hpp"
 #import <cstdio>
 #import <sstream>
 
@@ -127,6 +119,20 @@ Mesh::Mesh(const char *filename)
     if(noTexture)
         printf("Texture cannot be applied to this OBJ (%s).\n", filename);
     
+    // pentagons and quads are drawn as fans of 3 and 2 triangles
+    for(unsigned int iSubmesh=0; iSubmesh<submeshFaces.size(); iSubmesh++)
+    {
+        int triangles = 0;
+        for(Face* face : submeshFaces.at(iSubmesh))
+            triangles += face->isPentagon ? 3 : (face->isQuad ? 2 : 1);
+        submeshTriangles.push_back(triangles);
+        triangleCount += triangles;
+    }
+    
+#ifdef HEADLESS
+    // only the vertices are needed (for bounding spheres)
+    return;
+#else
     modelid = glGenLists(submeshFaces.size());
     
     for(int iSubmesh=0; iSubmesh<submeshFaces.size(); iSubmesh++)
@@ -241,17 +247,26 @@ Mesh::Mesh(const char *filename)
         
         glEndList();
     }
+#endif
 }
 
 void Mesh::draw()
 {
+#ifndef HEADLESS
     for(int iSubmesh=0; iSubmesh<submeshFaces.size(); iSubmesh++)
         glCallList(modelid + iSubmesh);
+    Metrics::add(Metrics::DRAW_CALLS, submeshFaces.size());
+    Metrics::add(Metrics::TRIANGLES, triangleCount);
+#endif
 }
 
 void Mesh::drawSubmesh(unsigned int iSubmesh)
 {
+#ifndef HEADLESS
     glCallList(modelid + iSubmesh);
+    Metrics::add(Metrics::DRAW_CALLS);
+    Metrics::add(Metrics::TRIANGLES, submeshTriangles.at(iSubmesh));
+#endif
 }
 
 Mesh::~Mesh()
@@ -10,6 +10,7 @@
 #import "float2.h"
 #import "float3.h"
 #import <vector>
+#import <string>
 
 class   Mesh
 {
@@ -29,6 +30,8 @@ class   Mesh
     std::vector<float2*>		texcoords;
     
     int            modelid;
+    std::vector<int>	submeshTriangles; // triangles each display list submits
+    int            triangleCount = 0;
     
 public:
     Mesh(const char *filename);
@@ -36,6 +39,7 @@ public:
     
     void        draw();
     void        drawSubmesh(unsigned int iSubmesh);
-    std::vector<float3*> getVertices() { return positions; }
+    const std::vector<float3*>& getVertices() { return positions; }
+    int         getTriangleCount() { return triangleCount; }
 };
 
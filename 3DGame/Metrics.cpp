@@ -0,0 +1,96 @@
+//
+//  Metrics.cpp
+//  Mario Typer
+//
+
+#import <stdio.h>
+#import <stdlib.h>
+#import <new>
+#import "Metrics.hpp"
+#import "Timestep.hpp"
+
+std::atomic<long long> Metrics::counters[NUM_COUNTERS];
+long long Metrics::frameTotals[NUM_COUNTERS];
+long long Metrics::periodTotals[NUM_COUNTERS];
+int Metrics::periodFrames = 0;
+double Metrics::periodStart = -1;
+double Metrics::logInterval = 0;
+
+const char* Metrics::name(int counter)
+{
+    static const char* names[NUM_COUNTERS] = {
+        "draw_calls", "triangles", "texture_binds", "material_applies", "spawns", "erases",
+        "allocations", "allocated_bytes"
+    };
+    return names[counter];
+}
+
+void Metrics::endFrame()
+{
+    for(int i=0; i<NUM_COUNTERS; i++) {
+        frameTotals[i] = counters[i].exchange(0, std::memory_order_relaxed);
+        periodTotals[i] += frameTotals[i];
+    }
+    periodFrames++;
+    
+    double now = monotonicSeconds();
+    if(periodStart < 0) periodStart = now;
+    if(logInterval > 0 && now - periodStart >= logInterval) {
+        printf("metrics frames=%d seconds=%.1f", periodFrames, now - periodStart);
+        for(int i=0; i<NUM_COUNTERS; i++)
+            printf(" %s=%.1f", name(i), (double)periodTotals[i] / periodFrames);
+        printf("\n");
+        for(int i=0; i<NUM_COUNTERS; i++)
+            periodTotals[i] = 0;
+        periodFrames = 0;
+        periodStart = now;
+    }
+}
+
+// Every allocation of the program goes through here. The counters are
+// plain relaxed atomics, which are safe to touch before main() runs.
+void* operator new(size_t size)
+{
+    Metrics::add(Metrics::ALLOCATIONS);
+    Metrics::add(Metrics::ALLOCATED_BYTES, size);
+    void* p = malloc(size ? size : 1);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    Metrics::add(Metrics::ALLOCATIONS);
+    Metrics::add(Metrics::ALLOCATED_BYTES, size);
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& nothrow) noexcept
+{
+    return operator new(size, nothrow);
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
@@ -0,0 +1,44 @@
+//
+//  Metrics.hpp
+//  Mario Typer
+//
+//  Per-frame counters of the work the game submits: draw calls, triangles,
+//  texture binds, material applies, objects spawned and erased, and heap
+//  allocations (counted by a replacement operator new). Counters may be
+//  bumped from any thread; endFrame() closes a frame and keeps its totals
+//  for the stats panel, and can print a periodic summary line.
+//
+
+#ifndef Metrics_hpp
+#define Metrics_hpp
+
+#import <atomic>
+
+class Metrics
+{
+public:
+    enum Counter { DRAW_CALLS, TRIANGLES, TEXTURE_BINDS, MATERIAL_APPLIES, SPAWNS, ERASES,
+                   ALLOCATIONS, ALLOCATED_BYTES, NUM_COUNTERS };
+    
+    static void add(Counter counter, long long n = 1)
+    { counters[counter].fetch_add(n, std::memory_order_relaxed); }
+    // running total since the last endFrame()
+    static long long current(Counter counter)
+    { return counters[counter].load(std::memory_order_relaxed); }
+    static long long lastFrame(Counter counter) { return frameTotals[counter]; }
+    static const char* name(int counter);
+    
+    // print a "metrics ..." line of per-frame averages every interval seconds, 0 = never
+    static void setLogInterval(double seconds) { logInterval = seconds; }
+    static void endFrame();
+    
+private:
+    static std::atomic<long long> counters[NUM_COUNTERS];
+    static long long frameTotals[NUM_COUNTERS];
+    static long long periodTotals[NUM_COUNTERS];
+    static int periodFrames;
+    static double periodStart;
+    static double logInterval;
+};
+
+#endif /* Metrics_hpp */
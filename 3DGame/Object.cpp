@@ -7,72 +7,78 @@
 //
 
 #import "Object.hpp"
-
-// return random integer between min and max (inclusive)
-int rand(int min, int max) { return rand()%(max-min + 1) + min; }
+#import "Lanes.hpp"
 
 Object* Object::translate(float3 offset){
     position += offset;
-    sphereCenter += offset;
+    markDirty();
     return this;
 }
 Object* Object::scale(float3 factor){
     scaleFactor *= factor;
-    sphereRadius *= fmax(factor.x, fmax(factor.y, factor.z));
-    sphereCenter *= factor;
+    markDirty();
     return this;
 }
 Object* Object::rotate(float angle){
     orientationAngle += angle;
     if(orientationAngle >= 360) orientationAngle -= 360;
     if(orientationAngle <= 0) orientationAngle += 360;
-    // printf("Rotating by %f degrees.\n", angle);
-    // printf("Sphere Center before rotation: (%f, %f, %f).\n", sphereCenter.x, sphereCenter.y, sphereCenter.z);
-    
-    float theta = (angle/180)*M_PI;
-    float a = position.x;
-    float b = position.y;
-    float c = position.z;
-    float x = sphereCenter.x;
-    float y = sphereCenter.y;
-    float z = sphereCenter.z;
-    float u = orientationAxis.x;
-    float v = orientationAxis.y;
-    float w = orientationAxis.z;
-    
-    // Formula for computing rotation of 3D point around arbitrary axis.
-    
-    sphereCenter.x = (a*(v*v + w*w) - u*(b*v + c*w - u*x - v*y - w*z))*(1 - cos(theta))
-    + (x*cos(theta)) + (-c*v + b*w - w*y + v*z)*sin(theta);
-    sphereCenter.y = (b*(u*u + w*w) - v*(a*u + c*w - u*x - v*y - w*z))*(1 - cos(theta))
-    + (y*cos(theta)) + (c*u - a*w + w*x - u*z)*sin(theta);
-    sphereCenter.z = (c*(u*u + v*v) - w*(a*u + b*v - u*x - v*y - w*z))*(1 - cos(theta))
-    + (z*cos(theta)) + (-b*u + a*v - v*x + u*y)*sin(theta);
-    
-    // printf("Sphere Center after rotation: (%f, %f, %f).\n\n", sphereCenter.x, sphereCenter.y, sphereCenter.z);
+    markDirty();
     return this;
 }
 
-void Object::draw(bool drawSpheres)
+float4x4 Object::computeTransform()
+{
+    return float4x4::translation(position)
+    * float4x4::rotation(orientationAngle, orientationAxis)
+    * float4x4::scaling(scaleFactor);
+}
+
+void Object::updateTransform()
+{
+    transform = computeTransform();
+    // the bounding sphere goes through the same matrix as the model
+    worldSphereCenter = transform.transformPoint(sphereCenter);
+    worldSphereRadius = sphereRadius * fmax(fabs(scaleFactor.x), fmax(fabs(scaleFactor.y), fabs(scaleFactor.z)));
+    transformDirty = false;
+}
+
+void Object::storePreviousTransform()
+{
+    previousTransform = getTransform();
+    hasPreviousTransform = true;
+    moved = false;
+}
+
+// world matrix blended between the previous and current simulation step
+float4x4 Object::getRenderTransform(float alpha)
+{
+    if(!moved || !hasPreviousTransform)
+        return getTransform();
+    return float4x4::lerp(previousTransform, getTransform(), alpha);
+}
+
+void Object::draw(bool drawSpheres, float alpha)
 {
+#ifndef HEADLESS
     glEnable(GL_LIGHTING);
     glEnable(GL_TEXTURE_2D);
     material->apply();
     // apply scaling, translation and orientation
     glMatrixMode(GL_MODELVIEW);
     glPushMatrix();
-    glTranslatef(position.x, position.y, position.z);
-    glRotatef(orientationAngle, orientationAxis.x, orientationAxis.y, orientationAxis.z);
-    glScalef(scaleFactor.x, scaleFactor.y, scaleFactor.z);
+    glMultMatrixf(getRenderTransform(alpha).m);
     drawModel();
     glPopMatrix();
     if(drawSpheres && type != NEUTRAL) {
         drawSphere();
     }
+#endif
 }
 
 void Object::drawSphere()
 {
+#ifndef HEADLESS
     glDisable(GL_LIGHTING);
     glDisable(GL_TEXTURE_2D);
     if(colliding) {
@@ -82,10 +88,28 @@ void Object::drawSphere()
     }
     glMatrixMode(GL_MODELVIEW);
     glPushMatrix();
-    glTranslatef(sphereCenter.x, sphereCenter.y, sphereCenter.z);
-    // glRotatef(orientationAngle, orientationAxis.x, orientationAxis.y, orientationAxis.z);
-    glutWireSphere(sphereRadius, 10, 10);
+    float3 c = center();
+    glTranslatef(c.x, c.y, c.z);
+    glutWireSphere(boundingRadius(), 10, 10);
     glPopMatrix();
+#endif
+}
+
+void MeshInstance::control(const std::vector<bool>& keysPressed, const LaneIndex& lanes, int currentLevel, float dt, Random& rng) {
+    if(type == AVATAR)
+        collide(lanes.beginAll(), lanes.endAll());
+}
+
+void MeshInstance::collide(Object* const* first, Object* const* last) {
+    PROFILE_SCOPE("collision");
+    bool foundCollision = false;
+    for(Object* const* obj = first; obj != last; ++obj) {
+        if(*obj != this)
+            if(this->interact(*obj))
+                foundCollision = true;
+    }
+    if(!foundCollision)
+        colliding = false;
 }
 
 bool MeshInstance::interact(Object* obj) {
@@ -100,7 +124,8 @@ bool MeshInstance::interact(Object* obj) {
             collisionTime++;
             if(collisionTime > 0 && obj->type == ENEMY) {
                 if(type == FRIENDLY_PROJECTILE) {
-                    obj->kill();
+                    // only Enemy and Projectile objects are created with these types
+                    static_cast<Enemy*>(obj)->hit(static_cast<Projectile*>(this)->getShot());
                     this->kill();
                     collisionTime = 0;
                 } else if(type == AVATAR) {
@@ -112,8 +137,9 @@ bool MeshInstance::interact(Object* obj) {
     return foundCollision;
 }
 
-void MeshInstance::drawShadow(float3 lightDir, float3 groundNormal, float3 groundPosition)
+void MeshInstance::drawShadow(float3 lightDir, float3 groundNormal, float3 groundPosition, float alpha)
 {
+#ifndef HEADLESS
     if(!shadow) return;
     float shear[] = {
         1, 0, 0, 0,
@@ -125,61 +151,47 @@ void MeshInstance::drawShadow(float3 lightDir, float3 groundNormal, float3 groun
     glDisable(GL_TEXTURE_2D);
     // glColor3f(0,0,0);
     glColor4f(0, 0, 0, 0.8);
-    // apply scaling, translation and orientation
+    // flatten onto the ground plane, then apply the cached object transform
+    float4x4 modelTransform = getRenderTransform(alpha);
+    float4x4 shadowTransform = float4x4::scaling(float3(1, 0, 1))
+    * float4x4::translation(float3(0, groundPosition.y-modelTransform.getTranslation().y, 0))
+    * float4x4(shear)
+    * modelTransform;
     glMatrixMode(GL_MODELVIEW);
     glPushMatrix();
-    glScalef(1, 0, 1);
-    glTranslatef(0, groundPosition.y-position.y, 0);
-    glMultMatrixf(shear);
-    glTranslatef(position.x, position.y, position.z);
-    glRotatef(orientationAngle, orientationAxis.x, orientationAxis.y, orientationAxis.z);
-    glScalef(scaleFactor.x, scaleFactor.y, scaleFactor.z);
+    glMultMatrixf(shadowTransform.m);
     drawModel();
     glPopMatrix();
+#endif
 }
 
-void Enemy::control(std::vector<bool>& keysPressed, std::vector<Object*> objects, int currentLevel) {
-    MeshInstance::control(keysPressed, objects, currentLevel);
-    Object* avatar = nullptr;
-    for(Object *obj : objects) {
-        if(obj->type == AVATAR)
-            avatar = obj;
-    }
-    // all enemies move toward avatar
+void Enemy::control(const std::vector<bool>& keysPressed, const LaneIndex& lanes, int currentLevel, float dt, Random& rng) {
+    Object* avatar = lanes.getAvatar();
+    // all enemies move toward avatar (speeds in units per second)
     if(avatar != nullptr)
     {
         float3 dir = (avatar->center()-this->center()).normalize();
-        float3 motionV = float3(0.01,0.01,0.01)*dir;
+        float3 motionV = dir*(speed*dt);
         translate(motionV);
-        translate(float3(0,0.01*sin(enemyVertTheta),0));
-        enemyVertTheta += M_PI/(18.0f/(0.8f));
+        translate(float3(0,0.6f*dt*sin(enemyVertTheta),0));
+        enemyVertTheta += (M_PI/(18.0f/(0.8f)))*60*dt;
     }
 }
 
-void Projectile::control(std::vector<bool>& keysPressed, std::vector<Object*> objects, int currentLevel) {
-    MeshInstance::control(keysPressed, objects, currentLevel);
-    Object* avatar = nullptr;
-    Enemy* towardEnemy = nullptr;
-    for(Object *obj : objects) {
-        if(obj->type == AVATAR) {
-            avatar = obj;
-        } else if(obj->type == ENEMY) {
-            Enemy* e = nullptr;
-            if((e = dynamic_cast<Enemy*>(obj))) {
-                if(e->getPosition() == this->getPosition()) {
-                    towardEnemy = e;
-                }
-            }
-        }
-    }
+void Projectile::control(const std::vector<bool>& keysPressed, const LaneIndex& lanes, int currentLevel, float dt, Random& rng) {
+    // only the enemies of its own lane can be hit
+    collide(lanes.begin(towardPosition), lanes.end(towardPosition));
+    Object* avatar = lanes.getAvatar();
+    Object* towardEnemy = lanes.newest(towardPosition);
     if(towardEnemy != nullptr && avatar != nullptr && type == Object::FRIENDLY_PROJECTILE)
     {
         // all projectiles spin
-        rotate(5);
-        orientationAxis += float3(rand(1,5)*0.2,rand(1,5)*0.2,rand(1,5)*0.2);
-        orientationAxis.normalize();
+        rotate(300*dt);
+        // the spin axis wobbles by 0.2 to 1 per axis every 1/60 s, whatever the step size
+        float wobble = 0.2f*60*dt;
+        setOrientationAxis(orientationAxis + float3(rng.range(1, 5)*wobble,rng.range(1, 5)*wobble,rng.range(1, 5)*wobble));
         
-        float3 dist = float3(0.2, 0.2, 0.2) * ((towardEnemy->center()-avatar->center()).normalize());
+        float3 dist = (towardEnemy->center()-avatar->center()).normalize() * (12*dt);
         translate(dist);
     }
 }
\ No newline at end of file
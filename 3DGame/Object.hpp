@@ -10,14 +10,15 @@
 #define Object_hpp
 
 #import <stdio.h>
-#import <OpenGL/gl.h>
-#import <OpenGL/glu.h>
-#import <GLUT/glut.h>
+#import "Random.hpp"
+#import "Profiler.hpp"
+#import "Platform.hpp"
 #import "float3.h"
+#import "float4x4.h"
 #import "Material.hpp"
 #import "Mesh.hpp"
 
-int rand(int min, int max);
+class LaneIndex;
 
 class Object
 {
@@ -27,8 +28,15 @@ protected:
     float3 position;
     float3 orientationAxis;
     float orientationAngle;
-    float3 sphereCenter = float3(0,0,0);
+    float3 sphereCenter = float3(0,0,0); // bounding sphere in model space
     float sphereRadius = 0;
+    float4x4 transform; // cached world matrix, rebuilt when transformDirty
+    bool transformDirty = true;
+    float4x4 previousTransform; // world matrix at the start of the current tick
+    bool hasPreviousTransform = false;
+    bool moved = false; // transform changed since previousTransform was taken
+    float3 worldSphereCenter;
+    float worldSphereRadius = 0;
     bool dead = false;
     bool colliding = false;
     float collisionTime = 0;
@@ -43,29 +51,40 @@ public:
     Object* scale(float3 factor);
     Object* rotate(float angle);
     float3 getOrientationAxis() { return orientationAxis; }
-    void setOrientationAxis(float3 axis) { orientationAxis = axis.normalize(); }
+    void setOrientationAxis(float3 axis) { orientationAxis = axis.normalize(); markDirty(); }
     float getAngle() { return orientationAngle; }
     float3 getPosition() { return position; }
     bool isColliding() { return colliding; }
     void setColliding(bool c) { colliding = c; }
-    float3 center() { return sphereCenter; }
-    float boundingRadius() { return sphereRadius; }
-    virtual void draw(bool drawSpheres);
+    const float4x4& getTransform() { if(transformDirty) updateTransform(); return transform; }
+    float3 center() { if(transformDirty) updateTransform(); return worldSphereCenter; }
+    float boundingRadius() { if(transformDirty) updateTransform(); return worldSphereRadius; }
+    virtual float4x4 computeTransform();
+    void updateTransform();
+    void markDirty() { transformDirty = true; moved = true; }
+    void storePreviousTransform();
+    float4x4 getRenderTransform(float alpha);
+    virtual void draw(bool drawSpheres, float alpha);
     virtual void drawSphere();
     virtual void drawModel()=0;
-    virtual void control(std::vector<bool>& keysPressed, std::vector<Object*> objects, int currentLevel) {}
+    virtual void control(const std::vector<bool>& keysPressed, const LaneIndex& lanes, int currentLevel, float dt, Random& rng) {}
     virtual bool interact(Object* obj) { return false; }
     virtual void move(double t, double dt){}
     virtual void kill() { dead = true; }
     virtual bool isDead() { return dead; }
-    virtual void drawShadow(float3 lightDir, float3 groundNormal, float3 groundPosition)=0;
+    virtual void drawShadow(float3 lightDir, float3 groundNormal, float3 groundPosition, float alpha)=0;
 };
 
 class Teapot : public Object
 {
 public:
     Teapot(Material* material):Object(material){}
-    void drawModel() { glutSolidTeapot(1.0f); }
+    void drawModel()
+    {
+#ifndef HEADLESS
+        glutSolidTeapot(1.0f);
+#endif
+    }
 };
 
 class MeshInstance : public Object
@@ -77,33 +96,27 @@ public:
     Object(material, t), mesh(mesh)
     {
         // construct collision sphere from mesh points
-        std::vector<float3*> vertices = mesh->getVertices();
+        const std::vector<float3*>& vertices = mesh->getVertices();
         int numV = 0;
         for(float3 *v : vertices) {
             sphereCenter += *v;
             numV++;
         }
-        sphereCenter /= numV;
+        if(numV > 0) sphereCenter /= numV;
         float dist = 0;
         for(float3 *v : vertices) {
             dist = (sphereCenter - *v).norm();
             if(dist > sphereRadius) sphereRadius = dist;
         }
     }
-    virtual void control(std::vector<bool>& keysPressed, std::vector<Object*> objects, int currentLevel) {
-        bool foundCollision = false;
-        for(Object *obj : objects) {
-            if(obj != this)
-                if(this->interact(obj))
-                    foundCollision = true;
-        }
-        if(!foundCollision)
-            colliding = false;
-    }
+    // the avatar tests itself against every enemy; other objects test nothing here
+    virtual void control(const std::vector<bool>& keysPressed, const LaneIndex& lanes, int currentLevel, float dt, Random& rng);
+    // tests against the objects from first up to last and sets the colliding flag
+    void collide(Object* const* first, Object* const* last);
     virtual bool interact(Object* obj);
     Object *setShadow(bool s) { shadow = s; return this; }
     void drawModel() { mesh->draw(); }
-    virtual void drawShadow(float3 lightDir, float3 groundNormal, float3 groundPosition);
+    virtual void drawShadow(float3 lightDir, float3 groundNormal, float3 groundPosition, float alpha);
 };
 
 class Ground : public MeshInstance
@@ -118,7 +131,7 @@ public:
         scale(float3(1,0.1,1));
         translate(float3(0,-0.1,0));
     }
-    void drawShadow(float3 lightDir, float3 groundNormal, float3 groundPosition) {}
+    void drawShadow(float3 lightDir, float3 groundNormal, float3 groundPosition, float alpha) {}
     float3 getNormal() { return normal; }
 };
 
@@ -138,30 +151,15 @@ public:
         scale(float3(6,1,15));
         rotate(-90);
     }
-    virtual void draw(bool drawSpheres)
+    virtual float4x4 computeTransform()
     {
-        glEnable(GL_LIGHTING);
-        glEnable(GL_TEXTURE_2D);
-        material->apply();
-        // apply scaling, translation and orientation
-        glMatrixMode(GL_MODELVIEW);
-        glPushMatrix();
-        glTranslatef(position.x, position.y, position.z);
-        if(oAxis2.norm2() != 0) {
-            orientationAxis = oAxis2;
-            glRotatef(orientationAngle, orientationAxis.x, orientationAxis.y, orientationAxis.z);
-        }
-        if(oAxis1.norm2() != 0)
-            orientationAxis = oAxis1;
-        glRotatef(orientationAngle, orientationAxis.x, orientationAxis.y, orientationAxis.z);
-        glScalef(scaleFactor.x, scaleFactor.y, scaleFactor.z);
-        drawModel();
-        glPopMatrix();
-        if(drawSpheres && type != NEUTRAL) {
-            drawSphere();
-        }
+        float4x4 m = float4x4::translation(position);
+        if(oAxis2.norm2() != 0)
+            m *= float4x4::rotation(orientationAngle, oAxis2);
+        m *= float4x4::rotation(orientationAngle, oAxis1.norm2() != 0 ? oAxis1 : orientationAxis);
+        return m * float4x4::scaling(scaleFactor);
     }
-    void drawShadow(float3 lightDir, float3 groundNormal, float3 groundPosition) {}
+    void drawShadow(float3 lightDir, float3 groundNormal, float3 groundPosition, float alpha) {}
     float3 getNormal() { return normal; }
 };
 
@@ -171,6 +169,9 @@ protected:
     int avatarPosition = 0;
     float enemyVertTheta = 0;
     int health = 1;
+    float speed = 0.6f; // towards the avatar, units per second
+    uint32_t woundShot = 0; // the typing attempt whose fireballs hit last, and how often
+    int wounds = 0;
 public:
     Enemy(Mesh* mesh, Material* material, int position, int health, Type t = ENEMY):
     MeshInstance(mesh, material, t)
@@ -178,19 +179,39 @@ public:
         avatarPosition = position;
         this->health = health;
     }
-    virtual void control(std::vector<bool>& keysPressed, std::vector<Object*> objects, int currentLevel);
+    virtual void control(const std::vector<bool>& keysPressed, const LaneIndex& lanes, int currentLevel, float dt, Random& rng);
     int getPosition() { return avatarPosition; }
     int getHealth() { return health; }
+    Enemy* setSpeed(float s) { speed = s; return this; }
     virtual void kill() {
         if(health > 1) health--;
         else dead = true;
     }
+    // a fireball of typing attempt shot hits
+    void hit(uint32_t shot) {
+        if(shot != woundShot) {
+            woundShot = shot;
+            wounds = 0;
+        }
+        wounds++;
+        kill();
+    }
+    // gives back the health taken by fireballs of typing attempt shot; false
+    // if it is already dead
+    bool heal(uint32_t shot) {
+        if(shot != woundShot || dead)
+            return false;
+        health += wounds;
+        wounds = 0;
+        return true;
+    }
 };
 
 class Projectile : public MeshInstance
 {
 protected:
     int towardPosition = 0;
+    uint32_t shot = 0; // the typing attempt that fired it
 public:
     Projectile(Mesh* mesh, Material* material, int position, Type t = FRIENDLY_PROJECTILE):
     MeshInstance(mesh, material, t)
@@ -198,7 +219,10 @@ public:
         towardPosition = position;
     }
     int getPosition() { return towardPosition; }
-    virtual void control(std::vector<bool>& keysPressed, std::vector<Object*> objects, int currentLevel);
+    void setTarget(int position) { towardPosition = position; }
+    uint32_t getShot() { return shot; }
+    Projectile* setShot(uint32_t s) { shot = s; return this; }
+    virtual void control(const std::vector<bool>& keysPressed, const LaneIndex& lanes, int currentLevel, float dt, Random& rng);
 };
 
 #endif /* Object_hpp */
\ No newline at end of file
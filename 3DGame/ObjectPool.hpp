@@ -0,0 +1,141 @@
+//
+//  ObjectPool.hpp
+//  Mario Typer
+//
+//  Fixed-capacity storage for objects that are created and destroyed all the
+//  time (projectiles, enemies). All slots are allocated once, aligned to
+//  cache lines, and recycled through a free list, so spawning and killing
+//  never touches the heap. Nothing keeps pointers into a pool across ticks:
+//  fireballs aim at a lane and enemies are found through the LaneIndex that
+//  is rebuilt every tick, so a recycled slot is never mistaken for the object
+//  that used to live there.
+//
+
+#ifndef ObjectPool_hpp
+#define ObjectPool_hpp
+
+#import <stdint.h>
+#import <stdlib.h>
+#import <new>
+#import <type_traits>
+#import <utility>
+#import <vector>
+
+template <typename T>
+class ObjectPool
+{
+    static const size_t cacheLine = 64;
+
+    struct Slot
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        int32_t nextFree; // -1 ends the free list
+        bool alive;
+    };
+    // every slot starts on its own cache line
+    static const size_t slotSize = (sizeof(Slot) + cacheLine - 1) / cacheLine * cacheLine;
+
+    unsigned char* memory = NULL;
+    unsigned int capacity = 0;
+    unsigned int count = 0;
+    int32_t firstFree = -1;
+
+    Slot& slot(unsigned int i) { return *reinterpret_cast<Slot*>(memory + i*slotSize); }
+    T* object(unsigned int i) { return reinterpret_cast<T*>(&slot(i).storage); }
+
+public:
+    ObjectPool() {}
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+    ~ObjectPool()
+    {
+        clear();
+        free(memory);
+    }
+
+    // allocates all slots up front; call once before create()
+    bool reserve(unsigned int n)
+    {
+        void* p = NULL;
+        if(memory != NULL || posix_memalign(&p, cacheLine, n*slotSize) != 0)
+            return false;
+        memory = (unsigned char*)p;
+        capacity = n;
+        for(unsigned int i=0; i<n; i++) {
+            new (&slot(i)) Slot();
+            slot(i).nextFree = i+1 < n ? i+1 : -1;
+            slot(i).alive = false;
+        }
+        firstFree = n > 0 ? 0 : -1;
+        return true;
+    }
+
+    // constructs a T in a free slot; NULL when the pool is full
+    template <typename... Args>
+    T* create(Args&&... args)
+    {
+        if(firstFree < 0)
+            return NULL;
+        unsigned int i = firstFree;
+        firstFree = slot(i).nextFree;
+        slot(i).alive = true;
+        count++;
+        return new (&slot(i).storage) T(std::forward<Args>(args)...);
+    }
+
+    // p must have come from create() of this pool
+    void destroy(T* p)
+    {
+        unsigned int i = indexOf(p);
+        p->~T();
+        slot(i).alive = false;
+        slot(i).nextFree = firstFree;
+        firstFree = i;
+        count--;
+    }
+
+    // destroys every live object
+    void clear()
+    {
+        for(unsigned int i=0; i<capacity; i++)
+            if(slot(i).alive)
+                destroy(object(i));
+    }
+
+    bool owns(const void* p) const
+    {
+        const unsigned char* c = (const unsigned char*)p;
+        return c >= memory && c < memory + capacity*slotSize;
+    }
+
+    unsigned int size() const { return count; }
+    unsigned int getCapacity() const { return capacity; }
+
+private:
+    unsigned int indexOf(const T* p) const
+    {
+        return (unsigned int)(((const unsigned char*)p - memory) / slotSize);
+    }
+};
+
+// Removes every item for which remove(item) returns true, by moving the last
+// item into its place. That is O(1) per removal, however many items die at
+// once, but does not keep the order. remove() is where a dying item gets
+// cleaned up. Returns the number of items removed.
+template <typename T, typename Remove>
+unsigned int swapAndPop(std::vector<T>& items, Remove remove)
+{
+    unsigned int removed = 0;
+    for(size_t i=0; i<items.size(); ) {
+        if(remove(items[i])) {
+            items[i] = items.back();
+            items.pop_back();
+            removed++;
+        } else {
+            i++;
+        }
+    }
+    return removed;
+}
+
+#endif /* ObjectPool_hpp */
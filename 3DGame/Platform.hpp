@@ -0,0 +1,35 @@
+//
+//  Platform.hpp
+//  Mario Typer
+//
+//  Single place that pulls in OpenGL/GLUT. Building with HEADLESS defined
+//  leaves them out entirely so the simulation can run without a window.
+//
+
+#ifndef Platform_hpp
+#define Platform_hpp
+
+#ifndef HEADLESS
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+// Needed on MsWindows
+#include <windows.h>
+#endif // Win32 platform
+
+#import <OpenGL/gl.h>
+#import <OpenGL/glu.h>
+// Download glut from: http://www.opengl.org/resources/libraries/glut/
+#import <GLUT/glut.h>
+
+#else
+
+// the few GL names that appear in declarations shared with the headless build
+typedef unsigned int GLenum;
+typedef unsigned int GLuint;
+typedef int GLint;
+#define GL_LINEAR 0x2601
+#define GL_LINEAR_MIPMAP_LINEAR 0x2703
+
+#endif // HEADLESS
+
+#endif /* Platform_hpp */
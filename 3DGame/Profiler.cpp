@@ -0,0 +1,87 @@
+//
+//  Profiler.cpp
+//  Mario Typer
+//
+
+#import <stdio.h>
+#import <algorithm>
+#import <mutex>
+#import <vector>
+#import "Profiler.hpp"
+
+// buffers are created on a thread's first scope and live until exit, so
+// scopes of finished worker threads can still be exported
+static std::mutex buffersMutex;
+static std::vector<ProfileBuffer*> buffers;
+static thread_local ProfileBuffer* threadBuffer = NULL;
+
+// frame-to-frame intervals, rolling window
+static const int frameWindow = 240;
+static float frameIntervals[frameWindow];
+static int framesRecorded = 0;
+static double lastFrame = -1;
+
+void Profiler::record(const char* name, double start, double end)
+{
+    if(threadBuffer == NULL) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        threadBuffer = new ProfileBuffer((int)buffers.size());
+        buffers.push_back(threadBuffer);
+    }
+    unsigned int n = threadBuffer->written.load(std::memory_order_relaxed);
+    ProfileEvent& event = threadBuffer->events[n & (ProfileBuffer::capacity - 1)];
+    event.name = name;
+    event.start = start;
+    event.duration = end - start;
+    threadBuffer->written.store(n + 1, std::memory_order_release);
+}
+
+bool Profiler::exportTrace(const char* filename)
+{
+    FILE* file = fopen(filename, "w");
+    if(!file)
+        return false;
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    int exported = 0;
+    for(ProfileBuffer* buffer : buffers) {
+        fprintf(file, "%s{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"thread %d\"}}",
+                first ? "" : ",\n", buffer->thread, buffer->thread);
+        first = false;
+        unsigned int written = buffer->written.load(std::memory_order_acquire);
+        unsigned int begin = written > ProfileBuffer::capacity ? written - ProfileBuffer::capacity : 0;
+        for(unsigned int i=begin; i<written; i++) {
+            const ProfileEvent& event = buffer->events[i & (ProfileBuffer::capacity - 1)];
+            fprintf(file, ",\n{\"ph\": \"X\", \"name\": \"%s\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                    event.name, buffer->thread, event.start * 1e6, event.duration * 1e6);
+            exported++;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    printf("Wrote %d profile scopes from %d threads to %s\n", exported, (int)buffers.size(), filename);
+    return true;
+}
+
+void Profiler::frame()
+{
+    double now = monotonicSeconds();
+    if(lastFrame >= 0)
+        frameIntervals[framesRecorded++ % frameWindow] = (float)(now - lastFrame) * 1000;
+    lastFrame = now;
+}
+
+bool Profiler::frameTimes(float& p50, float& p95, float& p99)
+{
+    int n = std::min(framesRecorded, frameWindow);
+    if(n == 0)
+        return false;
+    float sorted[frameWindow];
+    std::copy(frameIntervals, frameIntervals + n, sorted);
+    std::sort(sorted, sorted + n);
+    p50 = sorted[n/2];
+    p95 = sorted[std::min(n-1, n*95/100)];
+    p99 = sorted[std::min(n-1, n*99/100)];
+    return true;
+}
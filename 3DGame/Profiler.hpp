@@ -0,0 +1,68 @@
+//
+//  Profiler.hpp
+//  Mario Typer
+//
+//  Scoped CPU profiler. PROFILE_SCOPE("name") times the rest of the enclosing
+//  block when the build defines MARIO_PROFILE, and compiles to nothing
+//  otherwise. Every thread writes its scopes into its own ring buffer, so
+//  recording never takes a lock; exportTrace() writes the buffered scopes
+//  of all threads as a Chrome trace (chrome://tracing or ui.perfetto.dev).
+//
+//  Frame times are tracked in every build, for the on-screen overlay.
+//
+
+#ifndef Profiler_hpp
+#define Profiler_hpp
+
+#import <atomic>
+#import "Timestep.hpp"
+
+#ifdef MARIO_PROFILE
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+struct ProfileEvent
+{
+    const char* name; // must outlive the profiler, i.e. a string literal
+    double start;     // monotonicSeconds()
+    double duration;
+};
+
+// the most recent scopes of one thread
+struct ProfileBuffer
+{
+    static const unsigned int capacity = 1 << 14;
+    ProfileEvent events[capacity];
+    std::atomic<unsigned int> written; // total events ever recorded; the latest ones are kept
+    int thread;
+    ProfileBuffer(int thread):written(0), thread(thread) {}
+};
+
+class Profiler
+{
+public:
+    static void record(const char* name, double start, double end);
+    // Chrome trace event JSON of everything still buffered. Threads that keep
+    // recording during the export may overwrite their oldest events.
+    static bool exportTrace(const char* filename);
+
+    // call once per presented frame
+    static void frame();
+    // over the last few seconds of frames, in milliseconds; false until there are two frames
+    static bool frameTimes(float& p50, float& p95, float& p99);
+};
+
+class ProfileScope
+{
+    const char* name;
+    double start;
+public:
+    ProfileScope(const char* name):name(name), start(monotonicSeconds()) {}
+    ~ProfileScope() { Profiler::record(name, start, monotonicSeconds()); }
+};
+
+#endif /* Profiler_hpp */
@@ -0,0 +1,70 @@
+//
+//  Random.hpp
+//  Mario Typer
+//
+//  Small, fast, seedable generator (xoshiro128**). Each Scene owns one, so
+//  games never share hidden state and replay exactly from the same seed.
+//
+
+#ifndef Random_hpp
+#define Random_hpp
+
+#import <stdint.h>
+
+class Random
+{
+    uint32_t s[4];
+    
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+public:
+    Random(uint64_t seed = 1) { this->seed(seed); }
+    
+    // expand the seed with splitmix64 so that any value, even 0, gives a good state
+    void seed(uint64_t value)
+    {
+        for(int i=0; i<4; i+=2) {
+            uint64_t z = (value += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            z = z ^ (z >> 31);
+            s[i] = (uint32_t)z;
+            s[i+1] = (uint32_t)(z >> 32);
+        }
+    }
+    
+    uint32_t next()
+    {
+        uint32_t result = rotl(s[1] * 5, 7) * 9;
+        uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 11);
+        return result;
+    }
+    
+    // uniform in [0, n) without modulo bias (Lemire's multiply-and-reject)
+    uint32_t below(uint32_t n)
+    {
+        uint64_t m = (uint64_t)next() * n;
+        uint32_t low = (uint32_t)m;
+        if(low < n) {
+            uint32_t threshold = (0u - n) % n;
+            while(low < threshold) {
+                m = (uint64_t)next() * n;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+    
+    // uniform integer between min and max (inclusive)
+    int range(int min, int max) { return min + (int)below((uint32_t)(max - min) + 1); }
+    
+    // uniform in [0, 1)
+    float uniform() { return (next() >> 8) * (1.0f / 16777216.0f); }
+};
+
+#endif /* Random_hpp */
@@ -0,0 +1,783 @@
+//
+//  Scene.cpp
+//  Mario Typer
+//
+
+#define _USE_MATH_DEFINES
+#import <math.h>
+#import <string.h>
+#import <algorithm>
+#import "Scene.hpp"
+#import "Metrics.hpp"
+#import "Dictionary.hpp"
+
+// enemies a station can have at once (a new one may spawn while fireballs
+// are still flying at the last), and fireballs in flight per station
+static unsigned int enemyCapacity(int lanes) { return std::max(16, 4*lanes); }
+static unsigned int projectileCapacity(int lanes) { return std::max(256, 64*lanes); }
+
+void Scene::setLaneCount(int count)
+{
+    laneCount = std::min(std::max(count, 1), maxLanes);
+    words.assign(laneCount, "");
+    wordsBeginTypingIndex.assign(laneCount, 0);
+    laneEnemies.assign(laneCount, 0);
+    wordTrie = WordTrie(laneCount);
+    lanes.setLaneCount(laneCount, std::max(enemyPool.getCapacity(), std::max(enemyCapacity(laneCount), waves.maxEnemies())));
+}
+
+void Scene::setWaves(const WaveSchedule& schedule)
+{
+    waves = schedule;
+    setLaneCount(laneCount);
+}
+
+void Scene::applyLogSettings(const InputLog& log)
+{
+    anyLane = log.anyLane;
+    setLaneCount(log.lanes);
+    WaveSchedule schedule;
+    if(!log.waves.empty())
+        schedule.parse(log.waves, "in the input log");
+    setWaves(schedule);
+}
+
+void Scene::initialize()
+{
+    // BUILD THE SCENE HERE
+    
+    lightSources.push_back(
+                           new DirectionalLight(
+                                                float3(1, 1, -1).normalize(),
+                                                float3(1, 0.5, 1)));
+    lightSources.push_back(
+                           new PointLight(
+                                          float3(-1, -1, 1),
+                                          float3(0.2, 0.1, 0.1)));
+    
+    Material* yellowDiffuseMaterial = new Material();
+    yellowDiffuseMaterial->kd = float3(1, 1, 0);
+    
+    materials.push_back(new TexturedMaterial("res/lava.png", GL_LINEAR));
+    materials.push_back(new TexturedMaterial("res/marioD.jpg", GL_LINEAR));
+    materials.push_back(new TexturedMaterial("res/boo-body-white.png", GL_LINEAR));
+    materials.push_back(new TexturedMaterial("res/stone.png", GL_LINEAR));
+    materials.push_back(new TexturedMaterial("res/gate.bmp", GL_LINEAR));
+    materials.push_back(new TexturedMaterial("res/fire.jpeg", GL_LINEAR));
+    materials.push_back(new TexturedMaterial("res/grass.jpg", GL_LINEAR));
+    materials.push_back(new TexturedMaterial("res/sky.jpg", GL_LINEAR));
+    
+    meshes.push_back(new Mesh("res/plane.obj"));
+    meshes.push_back(new Mesh("res/mario_obj.obj"));
+    meshes.push_back(new Mesh("res/boo-body.obj"));
+    meshes.push_back(new Mesh("res/Pedestal.obj"));
+    meshes.push_back(new Mesh("res/gate.obj"));
+    meshes.push_back(new Mesh("res/mountain.obj"));
+    meshes.push_back(new Mesh("res/fireball.obj"));
+    
+    ground = new Ground(meshes.at(0), materials.at(3), float3(0,1,0), float3(0,0,0));
+    
+    // a station gets a new enemy only once its word is typed, so few are
+    // alive at a time; fireballs die on impact but can pile up on an empty lane
+    enemyPool.reserve(std::max(enemyCapacity(laneCount), waves.maxEnemies()));
+    projectilePool.reserve(std::max(projectileCapacity(laneCount), waves.maxFireballs()));
+    // room for every pooled object besides the scenery, so spawning never
+    // grows the list mid-game
+    objects.reserve(32 + enemyPool.getCapacity() + projectilePool.getCapacity());
+    
+    hudText.initialize();
+    
+    // ground
+    objects.push_back(ground);
+    // sky north
+    skies.push_back((new Sky(meshes.at(0), materials.at(7), float3(0,0,-1), float3(0,50,200), float3(1,0,0), float3(0,0,1))));
+    // sky west
+    skies.push_back((new Sky(meshes.at(0), materials.at(7), float3(0,0,-1), float3(200,50,0), float3(0,0,1), float3(0,0,0))));
+    // sky south
+    skies.push_back((new Sky(meshes.at(0), materials.at(7), float3(0,0,-1), float3(0,50,-200), float3(-1,0,0), float3(0,0,1))));
+    // sky east
+    skies.push_back((new Sky(meshes.at(0), materials.at(7), float3(0,0,-1), float3(-200,50,0), float3(0,0,-1), float3(0,0,0))));
+    // mountains north
+    objects.push_back((new MeshInstance(meshes.at(5), materials.at(0)))
+                      ->setShadow(false)
+                      ->translate(float3(0, -10, 100))
+                      ->scale(float3(0.000003, 0.000004, 0.000003)) );
+    // archway north
+    objects.push_back((new MeshInstance(meshes.at(4), materials.at(4)))
+                      ->translate(float3(3.3, 0, 18))
+                      ->rotate(90)
+                      ->scale(float3(1, 1, 1)) );
+    // pedestal north left
+    objects.push_back((new MeshInstance(meshes.at(3), materials.at(4)))
+                      ->translate(float3(5, 0, 7))
+                      ->scale(float3(0.4, 0.5, 0.4)) );
+    // pedestal north right
+    objects.push_back((new MeshInstance(meshes.at(3), materials.at(4)))
+                      ->translate(float3(-5, 0, 7))
+                      ->scale(float3(0.4, 0.5, 0.4)) );
+    // mountains east
+    objects.push_back((new MeshInstance(meshes.at(5), materials.at(0)))
+                      ->setShadow(false)
+                      ->translate(float3(-100, -10, 0))
+                      ->scale(float3(0.000003, 0.000004, 0.000003)) );
+    // archway east
+    objects.push_back((new MeshInstance(meshes.at(4), materials.at(4)))
+                      ->translate(float3(-5, 0, -3.3))
+                      ->rotate(180)
+                      ->scale(float3(1, 1, 1)) );
+    // pedestal east left
+    objects.push_back((new MeshInstance(meshes.at(3), materials.at(4)))
+                      ->translate(float3(-7, 0, 5))
+                      ->scale(float3(0.4, 0.5, 0.4)) );
+    // pedestal east right
+    objects.push_back((new MeshInstance(meshes.at(3), materials.at(4)))
+                      ->translate(float3(-7, 0, -5))
+                      ->scale(float3(0.4, 0.5, 0.4)) );
+    // mountains south
+    objects.push_back((new MeshInstance(meshes.at(5), materials.at(0)))
+                      ->setShadow(false)
+                      ->translate(float3(0, -10, -100))
+                      ->scale(float3(0.000003, 0.000004, 0.000003)) );
+    // archway south
+    objects.push_back((new MeshInstance(meshes.at(4), materials.at(4)))
+                      ->translate(float3(3.3, 0, -4.8))
+                      ->rotate(90)
+                      ->scale(float3(1, 1, 1)) );
+    // pedestal south left
+    objects.push_back((new MeshInstance(meshes.at(3), materials.at(4)))
+                      ->translate(float3(5, 0, -7))
+                      ->scale(float3(0.4, 0.5, 0.4)) );
+    // pedestal south right
+    objects.push_back((new MeshInstance(meshes.at(3), materials.at(4)))
+                      ->translate(float3(-5, 0, -7))
+                      ->scale(float3(0.4, 0.5, 0.4)) );
+    // mountains west
+    objects.push_back((new MeshInstance(meshes.at(5), materials.at(0)))
+                      ->setShadow(false)
+                      ->translate(float3(100, -10, 0))
+                      ->scale(float3(0.000003, 0.000004, 0.000003)) );
+    // archway west
+    objects.push_back((new MeshInstance(meshes.at(4), materials.at(4)))
+                      ->translate(float3(5, 0, 3.3))
+                      ->scale(float3(1, 1, 1)) );
+    // pedestal west left
+    objects.push_back((new MeshInstance(meshes.at(3), materials.at(4)))
+                      ->translate(float3(7, 0, 5))
+                      ->scale(float3(0.4, 0.5, 0.4)) );
+    // pedestal west right
+    objects.push_back((new MeshInstance(meshes.at(3), materials.at(4)))
+                      ->translate(float3(7, 0, -5))
+                      ->scale(float3(0.4, 0.5, 0.4)) );
+    
+    reset();
+    
+}
+
+Scene::~Scene()
+{
+    for (std::vector<LightSource*>::iterator iLightSource = lightSources.begin(); iLightSource != lightSources.end(); ++iLightSource)
+        delete *iLightSource;
+    for (std::vector<Material*>::iterator iMaterial = materials.begin(); iMaterial != materials.end(); ++iMaterial)
+        delete *iMaterial;
+    for (std::vector<Object*>::iterator iObject = objects.begin(); iObject != objects.end(); ++iObject)
+        destroyObject(*iObject);
+    for (std::vector<Object*>::iterator iSky = skies.begin(); iSky != skies.end(); ++iSky)
+        delete *iSky;
+}
+
+void Scene::reset()
+{
+    unsigned int removed = swapAndPop(objects, [this](Object* object) {
+        if(object->type == Object::NEUTRAL)
+            return false;
+        destroyObject(object);
+        return true;
+    });
+    Metrics::add(Metrics::ERASES, removed);
+    
+    avatarPosition = 0;
+    noClipMode = false;
+    gameOver = false;
+    gamePaused = true;
+    currentLevel = 1;
+    time = 0;
+    spawnClock = 0;
+    wordsTyped = 0;
+    enemiesKilled = 0;
+    peakEnemies = 0;
+    peakFireballs = 0;
+    waveIndex = 0;
+    waveTime = 0;
+    burstClock = 0;
+    if(!waves.empty())
+        currentLevel = waves[0].level;
+    laneEnemies.assign(laneCount, 0);
+    
+    for(int i=0; i<laneCount; i++) {
+        words[i] = "";
+        wordsBeginTypingIndex[i] = 0;
+    }
+    wordLetters = 0;
+    memset(wordLetterCounts, 0, sizeof(wordLetterCounts));
+    wordHistory.clear();
+    wordTrie.clear();
+    typedNode = WordTrie::root;
+    typedLength = 0;
+    targetLane = -1;
+    shotSerial = 0;
+    shotsFired = 0;
+    
+    // mario
+    avatar = (new MeshInstance(meshes.at(1), materials.at(1), Object::AVATAR))
+    ->scale(float3(0.008, 0.008, 0.008))
+    ->translate(float3(0, 0, 1))
+    ->rotate(10);
+    objects.push_back(avatar);
+    Metrics::add(Metrics::SPAWNS);
+    
+    camera = Camera();
+    camera.setAspectRatio((float)window_width/window_height);
+    camera.setTurnAngle(360.0f/laneCount);
+    
+}
+
+// advance the simulation by one fixed step of dt seconds, consuming the
+// key events that happened up to time until
+void Scene::control(float dt, InputQueue& input, double until)
+{
+    PROFILE_SCOPE("Scene::control");
+    drainInput(input, until);
+    
+    for(Object* object : objects)
+        object->storePreviousTransform();
+    
+    if(waves.empty() && ((time > 30 && currentLevel < 2) || (time > 60 && currentLevel < 3))) {
+        currentLevel++;
+        if(verbose) printf("Level %d!\n", currentLevel);
+    }
+    
+    // every press is handled exactly once, in the order it happened
+    for(const KeyEvent& event : stepEvents) {
+        if(event.down && keyPressed(event))
+            return; // game was reset, drop the rest of this step
+    }
+    
+    // Do camera and avatar moving
+    bool wasMoving = camera.isMoving();
+    camera.move(dt, keysHeld, noClipMode);
+    
+    if(gameOver || gamePaused) return;
+    time += dt;
+    
+    // Move avatar depending on camera rotation
+    if(camera.isMoving()) {
+        if(wasMoving) avatar->rotate(camera.movingLeft() ? camera.getMotionStep() : -camera.getMotionStep());
+        float theta = camera.getMotionAngle() * (camera.movingLeft() ? 1 : -1);
+        theta += laneAngle(avatarPosition, laneCount) + (camera.movingLeft() ? 0 : -M_PI*2);
+        float3 avatarPos = avatar->getPosition();
+        avatar->translate(float3(-avatarPos.x+sin(theta), -avatarPos.y, -avatarPos.z+cos(theta)));
+    } else {
+        if(wasMoving) {
+            avatarPosition += camera.movingLeft() ? 1 : -1;
+            if(avatarPosition < 0) avatarPosition = laneCount-1;
+            else if(avatarPosition >= laneCount) avatarPosition = 0;
+        }
+    }
+    
+    // Control objects
+    lanes.rebuild(objects);
+    for(Object* object : objects) {
+        object->control(keysHeld, lanes, currentLevel, dt, rng);
+    }
+    
+    removeDeadObjects();
+    if(gameOver) return;
+    
+    if(!waves.empty()) {
+        updateWaves(dt);
+    } else {
+        spawnClock += dt;
+        while(spawnClock >= spawnCheckInterval) {
+            spawnClock -= spawnCheckInterval;
+            trySpawn();
+        }
+    }
+    peakEnemies = std::max(peakEnemies, (int)enemyPool.size());
+    peakFireballs = std::max(peakFireballs, (int)projectilePool.size());
+}
+
+void Scene::record(InputLog* log, uint64_t seed, float dt)
+{
+    replayLog = NULL;
+    recordLog = log;
+    log->seed = seed;
+    log->stepSize = dt;
+    log->steps = 0;
+    log->finalHash = 0;
+    log->anyLane = anyLane;
+    log->lanes = laneCount;
+    log->waves = waves.source();
+    log->wordWeighting = getWordWeighting();
+    log->events.clear();
+    step = 0;
+    keysHeld.assign(NUM_KEYS, false);
+    rng.seed(seed);
+    reset();
+}
+
+void Scene::stopRecording()
+{
+    if(recordLog == NULL) return;
+    recordLog->steps = step;
+    recordLog->finalHash = stateHash();
+    recordLog = NULL;
+}
+
+void Scene::replay(const InputLog* log)
+{
+    recordLog = NULL;
+    replayLog = log;
+    step = 0;
+    nextReplayEvent = 0;
+    keysHeld.assign(NUM_KEYS, false);
+    rng.seed(log->seed);
+    applyLogSettings(*log);
+    reset();
+}
+
+// Moves this step's key events into stepEvents and updates the held keys.
+// While recording, the events are appended to the log; while replaying, the
+// live events are discarded and the logged ones for this step are used instead.
+void Scene::drainInput(InputQueue& input, double until)
+{
+    stepEvents.clear();
+    KeyEvent event;
+    if(replayLog != NULL) {
+        while(input.pop(event)) {}
+        while(nextReplayEvent < replayLog->events.size() && replayLog->events[nextReplayEvent].step <= step) {
+            const InputLog::Event& logged = replayLog->events[nextReplayEvent++];
+            KeyEvent replayed = { step * replayLog->stepSize, logged.key, logged.down };
+            stepEvents.push_back(replayed);
+        }
+    } else {
+        while(input.peek(event) && event.time <= until) {
+            input.pop(event);
+            if(event.key >= NUM_KEYS) continue;
+            stepEvents.push_back(event);
+            if(recordLog != NULL) {
+                InputLog::Event logged = { step, event.key, event.down };
+                recordLog->events.push_back(logged);
+            }
+        }
+    }
+    for(const KeyEvent& event : stepEvents)
+        keysHeld.at(event.key) = event.down;
+    step++;
+}
+
+// Reacts to one key press. Returns true if it reset the game.
+bool Scene::keyPressed(const KeyEvent& event)
+{
+    int key = event.key;
+    if(gameOver) {
+        if(key == '1') {
+            reset();
+            return true;
+        }
+    } else if(key == '2') {
+        gamePaused = !gamePaused;
+        return false;
+    }
+    
+    switch(key) {
+        case KEY_F1:
+            noClipMode = !noClipMode;
+            break;
+        case KEY_F2:
+            showSpheres = !showSpheres;
+            break;
+        case KEY_LEFT:
+        case KEY_RIGHT:
+            camera.queueTurn(key == KEY_LEFT);
+            break;
+        default:
+            if(key < 256) handleTyping(event);
+            break;
+    }
+    return false;
+}
+
+// FNV-1a over the simulation state, to check that a replay matched its recording
+uint64_t Scene::stateHash()
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    struct Hasher {
+        uint64_t& hash;
+        void add(const void* data, size_t size) {
+            for(size_t i=0; i<size; i++) {
+                hash ^= ((const unsigned char*)data)[i];
+                hash *= 0x100000001b3ull;
+            }
+        }
+    } hasher = { hash };
+    for(Object* object : objects) {
+        float3 position = object->getPosition();
+        float angle = object->getAngle();
+        hasher.add(&object->type, sizeof(object->type));
+        hasher.add(&position, sizeof(position));
+        hasher.add(&angle, sizeof(angle));
+    }
+    for(int i=0; i<laneCount; i++) {
+        hasher.add(words[i].data(), words[i].size());
+        hasher.add(&wordsBeginTypingIndex[i], sizeof(int));
+    }
+    hasher.add(&targetLane, sizeof(targetLane));
+    hasher.add(&waveIndex, sizeof(waveIndex));
+    hasher.add(&time, sizeof(time));
+    hasher.add(&avatarPosition, sizeof(avatarPosition));
+    hasher.add(&wordsTyped, sizeof(wordsTyped));
+    hasher.add(&enemiesKilled, sizeof(enemiesKilled));
+    hasher.add(&gameOver, sizeof(gameOver));
+    return hash;
+}
+
+// Runs once per tick, after every object has been controlled, so a burst of
+// kills costs one pass over the objects instead of one erase per kill.
+// A dead avatar stays in the scene and ends the game.
+void Scene::removeDeadObjects()
+{
+    PROFILE_SCOPE("removeDeadObjects");
+    unsigned int removed = swapAndPop(objects, [this](Object* object) {
+        if(!object->isDead())
+            return false;
+        if(object->type == Object::AVATAR) {
+            gameOver = true;
+            return false;
+        }
+        if(object->type == Object::ENEMY) {
+            enemiesKilled++;
+            laneEnemies[static_cast<Enemy*>(object)->getPosition()]--;
+        }
+        destroyObject(object);
+        return true;
+    });
+    Metrics::add(Metrics::ERASES, removed);
+}
+
+// returns pooled objects to their pool and deletes the rest
+void Scene::destroyObject(Object* object)
+{
+    if(enemyPool.owns(object))
+        enemyPool.destroy(static_cast<Enemy*>(object));
+    else if(projectilePool.owns(object))
+        projectilePool.destroy(static_cast<Projectile*>(object));
+    else
+        delete object;
+}
+
+void Scene::trySpawn()
+{
+    PROFILE_SCOPE("spawn");
+    // Do random word selection
+    int likelihood = floor((float)rng.range(0,10000) * (1.0f+(currentLevel*0.05f)));
+    if(likelihood > (10400 * (0.95f+(currentLevel*0.05f)))) {
+        int side = rng.range(0, laneCount-1);
+        if(words[side] == "") {
+            // no repeats of recent words, and no two words on screen with the
+            // same first letter while there are no more stations than letters
+            StringView word = wordHistory.pick(currentLevel, rng, laneCount <= 26 ? wordLetters : 0);
+            if(word.length == 0)
+                return; // nothing suitable this time, or no words for this level (yet)
+            if(!setWord(side, word))
+                return;
+            if(spawnEnemy(side, (int)word.length, 0.6f, 8) == NULL)
+                clearWord(side);
+        } else {
+            // printf("Tried changing #%d.\n", side+1);
+        }
+    }
+}
+
+// a boo at a station, distance units out from the avatar
+Enemy* Scene::spawnEnemy(int side, int health, float speed, float distance)
+{
+    Enemy *enemy = enemyPool.create(meshes.at(2), materials.at(2), side, health, Object::ENEMY);
+    if(enemy == NULL) {
+        if(verbose) printf("Enemy pool exhausted, skipped a spawn\n");
+        return NULL;
+    }
+    float angle = laneAngle(side, laneCount);
+    enemy->setSpeed(speed)
+    ->scale(float3(0.005, 0.005, 0.005))
+    ->translate(float3(distance*sinf(angle), 1.5, distance*cosf(angle)))
+    ->rotate(180 + 360.0f*side/laneCount);
+    objects.push_back(enemy);
+    laneEnemies[side]++;
+    Metrics::add(Metrics::SPAWNS);
+    return enemy;
+}
+
+// false if the word is already on screen
+bool Scene::setWord(int lane, StringView word)
+{
+    if(!wordTrie.insert(word.data, word.length, lane))
+        return false;
+    words[lane].assign(word.data, word.length);
+    int letter = word.data[0] - 'a';
+    wordLetterCounts[letter]++;
+    wordLetters |= 1u << letter;
+    if(verbose) printf("Word #%d is now: %s\n", lane, words[lane].c_str());
+    return true;
+}
+
+void Scene::clearWord(int lane)
+{
+    std::string& word = words[lane];
+    wordTrie.remove(word.data(), (unsigned int)word.length());
+    int letter = word[0] - 'a';
+    if(--wordLetterCounts[letter] == 0)
+        wordLetters &= ~(1u << letter);
+    wordsBeginTypingIndex[lane] = 0;
+    word = "";
+}
+
+// Moves the schedule along, spawns the bursts that are due and gives every
+// station that has enemies a word.
+void Scene::updateWaves(float dt)
+{
+    PROFILE_SCOPE("waves");
+    waveTime += dt;
+    burstClock += dt;
+    if(waveTime >= waves[waveIndex].duration) {
+        waveIndex = (waveIndex + 1) % waves.size();
+        waveTime = 0;
+        burstClock = 0;
+        currentLevel = waves[waveIndex].level;
+        if(verbose) printf("Wave %s!\n", waves[waveIndex].name.c_str());
+    }
+    const Wave& wave = waves[waveIndex];
+    while(burstClock >= wave.interval) {
+        burstClock -= wave.interval;
+        for(int i=0; i<wave.burst && enemyPool.size() < (unsigned int)wave.cap; i++) {
+            int side = rng.range(0, laneCount-1);
+            float distance = 8 + (wave.spread > 0 ? rng.uniform()*wave.spread : 0);
+            if(spawnEnemy(side, wave.health(waveTime), wave.speed, distance) == NULL)
+                break;
+        }
+    }
+    assignWords();
+}
+
+void Scene::assignWords()
+{
+    for(int lane=0; lane<laneCount; lane++) {
+        if(laneEnemies[lane] == 0 || words[lane] != "")
+            continue;
+        StringView word = wordHistory.pick(currentLevel, rng, laneCount <= 26 ? wordLetters : 0);
+        if(word.length > 0)
+            setWord(lane, word);
+    }
+}
+
+void Scene::handleTyping(const KeyEvent& event)
+{
+    PROFILE_SCOPE("handleTyping");
+    if(anyLane) {
+        int sample = latency ? latency->consumed(event.key, event.time) : -1;
+        handleAnyLaneTyping(event, sample);
+        return;
+    }
+    std::string& word = words[avatarPosition];
+    if(word != "") {
+        char c = word[wordsBeginTypingIndex[avatarPosition]];
+        int sample = latency ? latency->consumed(event.key, event.time) : -1;
+        if(event.key == (unsigned char)c) {
+            // printf("Typed '%c' in word '%s'\n", c, word.c_str());
+            wordsBeginTypingIndex[avatarPosition]++;
+            shoot(avatarPosition, sample);
+            if(wordsBeginTypingIndex[avatarPosition] >= word.length())
+                completeWord(avatarPosition);
+        }
+    }
+}
+
+// Follows the typed letters down the prefix tree of all words on screen.
+// A letter no word continues with is ignored; backspace drops the letters
+// typed so far. One step down the tree per key, whatever the number of lanes.
+void Scene::handleAnyLaneTyping(const KeyEvent& event, int sample)
+{
+    if(event.key == 8 || event.key == 127) {
+        if(targetLane >= 0)
+            wordsBeginTypingIndex[targetLane] = 0;
+        typedNode = WordTrie::root;
+        typedLength = 0;
+        targetLane = -1;
+        return;
+    }
+    int next = wordTrie.child(typedNode, (char)event.key);
+    if(next < 0)
+        return;
+    if(typedLength == 0) {
+        shotSerial++;
+        shotsFired = 0;
+    }
+    typedNode = next;
+    typedLength++;
+    // a word that ends here wins over longer words with the same prefix
+    int lane = wordTrie.endLane(next) >= 0 ? wordTrie.endLane(next) : wordTrie.lane(next);
+    if(lane != targetLane) {
+        // the letters so far spell another lane's word too: move them over
+        if(targetLane >= 0)
+            retarget(targetLane, lane);
+        targetLane = lane;
+    }
+    wordsBeginTypingIndex[lane] = typedLength;
+    shoot(lane, sample);
+    if(wordTrie.endLane(next) == lane)
+        completeWord(lane);
+}
+
+// Moves the letters typed so far from one lane's word to another's. Their
+// fireballs still in flight turn to the new lane. Those that already hit an
+// enemy of the old lane give it its health back and are fired again, so the
+// old enemy is unharmed and every letter hits the new lane once.
+void Scene::retarget(int from, int to)
+{
+    wordsBeginTypingIndex[from] = 0;
+    int landed = shotsFired;
+    for(Object* object : objects) {
+        if(object->type == Object::FRIENDLY_PROJECTILE) {
+            Projectile* fireball = static_cast<Projectile*>(object);
+            if(fireball->getShot() == shotSerial && fireball->getPosition() == from && !fireball->isDead()) {
+                fireball->setTarget(to);
+                landed--;
+            }
+        } else if(object->type == Object::ENEMY) {
+            Enemy* enemy = static_cast<Enemy*>(object);
+            if(enemy->getPosition() == from)
+                enemy->heal(shotSerial);
+        }
+    }
+    shotsFired -= landed;
+    fire(to, landed, -1);
+}
+
+// a volley toward a lane; the letter still counts if the pool is full
+void Scene::shoot(int lane, int sample)
+{
+    fire(lane, waves.empty() ? 1 : waves[waveIndex].volley, sample);
+}
+
+// count fireballs of the current typing attempt; returns how many the pool had room for
+int Scene::fire(int lane, int count, int sample)
+{
+    int fired = 0;
+    for(; fired<count; fired++) {
+        Projectile* fireball = projectilePool.create(meshes.at(6), materials.at(5), lane, Object::FRIENDLY_PROJECTILE);
+        if(fireball == NULL)
+            break;
+        objects.push_back(fireball
+                          ->setShot(shotSerial)
+                          ->scale(float3(0.1,0.1,0.1))
+                          ->translate(avatar->center()) );
+        Metrics::add(Metrics::SPAWNS);
+        if(latency && sample >= 0 && fired == 0) latency->spawned(sample);
+    }
+    shotsFired += fired;
+    return fired;
+}
+
+void Scene::completeWord(int lane)
+{
+    if(verbose) printf("Success: Typed word '%s'\n", words[lane].c_str());
+    clearWord(lane);
+    wordsTyped++;
+    typedNode = WordTrie::root;
+    typedLength = 0;
+    targetLane = -1;
+}
+
+// alpha: how far the frame lies between the previous and current simulation step
+// overlay: diagnostic lines drawn over the HUD, may be empty
+void Scene::draw(float alpha, const ArenaVector<const char*>& overlay)
+{
+#ifndef HEADLESS
+    PROFILE_SCOPE("Scene::draw");
+    frameArena.reset();
+    camera.apply(alpha);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glEnable(GL_BLEND);
+    unsigned int iLightSource=0;
+    for (; iLightSource<lightSources.size(); iLightSource++)
+    {
+        glEnable(GL_LIGHT0 + iLightSource);
+        lightSources.at(iLightSource)->apply(GL_LIGHT0 + iLightSource);
+    }
+    iLightSource=0;
+    for (; iLightSource<GL_MAX_LIGHTS; iLightSource++)
+        glDisable(GL_LIGHT0 + iLightSource);
+    
+    {
+        PROFILE_SCOPE("sky");
+        GpuTimerScope gpu(gpuTimers, GpuTimers::SKY);
+        for (unsigned int iSky=0; iSky<skies.size(); iSky++)
+            skies.at(iSky)->draw(false, alpha);
+    }
+    {
+        PROFILE_SCOPE("objects");
+        GpuTimerScope gpu(gpuTimers, GpuTimers::OBJECTS);
+        for (unsigned int iObject=0; iObject<objects.size(); iObject++)
+            objects.at(iObject)->draw(showSpheres, alpha);
+    }
+    {
+        PROFILE_SCOPE("shadows");
+        GpuTimerScope gpu(gpuTimers, GpuTimers::SHADOWS);
+        float3 lightDir = lightSources.at(0)->getLightDirAt(float3(0,0,0));
+        for (unsigned int iObject=0; iObject<objects.size(); iObject++)
+            objects.at(iObject)->drawShadow(lightDir, ground->getNormal(), ground->getPosition(), alpha);
+    }
+    {
+        GpuTimerScope gpu(gpuTimers, GpuTimers::HUD);
+        PROFILE_SCOPE("hud");
+        drawWord();
+        if(overlay.size() > 0)
+            drawOverlay(overlay);
+        hudText.flush(window_width, window_height);
+    }
+#endif
+}
+
+// queues the word of the lane in view, typed letters black and the rest white
+void Scene::drawWord()
+{
+#ifndef HEADLESS
+    PROFILE_SCOPE("drawWord");
+    int lane = hudLane();
+    const char* text = gameOver ? "YOU DIED" : (gamePaused ? "PAUSED (PRESS 2 TO UNPAUSE)" : words[lane].c_str());
+    ArenaString str(text, ArenaStlAllocator<char>(frameArena));
+    std::transform(str.begin(), str.end(), str.begin(), ::toupper);
+    const int scale = 2;
+    float wordStartX = ((float)window_width/2.0f) - TextBatch::width((unsigned int)str.length(), scale)/2;
+    float wordStartY = gameOver ? (float)window_height/2.0f : (float)window_height*0.95f;
+    uint32_t typed = textColor(0.0f, 0.0f, 0.0f);
+    uint32_t untyped = textColor(1.0f, 1.0f, 1.0f);
+    uint32_t dead = textColor(1.0f, 0.0f, 0.0f);
+    int i=0;
+    for(char c : str) {
+        uint32_t color = gameOver ? dead : (i < wordsBeginTypingIndex[lane] ? typed : untyped);
+        hudText.add(wordStartX + TextBatch::advance*scale*i, wordStartY, c, scale, color);
+        i++;
+    }
+#endif
+}
+
+// diagnostic text in the top left corner, one string per line
+void Scene::drawOverlay(const ArenaVector<const char*>& lines)
+{
+#ifndef HEADLESS
+    const int scale = 2;
+    uint32_t color = textColor(1.0f, 1.0f, 0.4f);
+    for(unsigned int i=0; i<lines.size(); i++)
+        hudText.add(10, (float)window_height - 20 - 18*i, lines[i], scale, color);
+#endif
+}
@@ -0,0 +1,190 @@
+//
+//  Scene.hpp
+//  Mario Typer
+//
+//  Game state and rules. Everything except draw()/drawWord() also builds
+//  with HEADLESS defined, so the simulation can run without GL or GLUT.
+//
+
+#ifndef Scene_hpp
+#define Scene_hpp
+
+#import <math.h>
+#import <vector>
+#import <string>
+#import "Random.hpp"
+#import "InputLog.hpp"
+#import "InputQueue.hpp"
+#import "Latency.hpp"
+#import "GpuTimers.hpp"
+#import "ObjectPool.hpp"
+#import "FrameArena.hpp"
+#import "Camera.hpp"
+#import "LightSource.hpp"
+#import "Object.hpp"
+#import "WordHistory.hpp"
+#import "WordTrie.hpp"
+#import "Lanes.hpp"
+#import "WaveSchedule.hpp"
+#import "TextBatch.hpp"
+
+const unsigned int window_width = 1200;
+const unsigned int window_height = 800;
+
+// keysPressed indices for the non-ASCII keys (0-255 are plain characters)
+enum SpecialKey { KEY_UP = 256, KEY_DOWN, KEY_LEFT, KEY_RIGHT, KEY_F1, KEY_F2, NUM_KEYS };
+
+struct GameStats
+{
+    float survivalTime; // seconds of unpaused play
+    int wordsTyped;
+    int enemiesKilled;
+    int level;
+    int peakEnemies;   // most alive at once
+    int peakFireballs;
+};
+
+class Scene
+{
+    Camera camera;
+    Ground *ground;
+    Object *avatar;
+    
+    std::vector<LightSource*> lightSources;
+    std::vector<Object*> objects;
+    std::vector<Object*> skies; // drawn in a pass of their own, never simulated
+    ObjectPool<Enemy> enemyPool;
+    ObjectPool<Projectile> projectilePool;
+    ArenaAllocator frameArena{1 << 16}; // HUD scratch memory, reset at the start of every frame
+    std::vector<Mesh*> meshes;
+    std::vector<Material*> materials;
+    
+    Random rng; // every random choice in the simulation comes from here
+    
+    int laneCount = 4; // stations around the avatar, each with its own word and enemies
+    LaneIndex lanes;   // this tick's enemies by lane
+    int avatarPosition = 0; // which station the avatar is looking at, 0 to laneCount-1
+    std::vector<bool> keysHeld = std::vector<bool>(NUM_KEYS, false);
+    std::vector<KeyEvent> stepEvents; // key events consumed by the current step
+    LatencyTracker* latency = NULL; // times typed letters when set
+    GpuTimers* gpuTimers = NULL; // times render passes when set
+    TextBatch hudText; // every HUD string of a frame, drawn at once
+    bool noClipMode = false;
+    bool showSpheres = false;
+    bool verbose = true; // print level and word changes
+    
+    bool gameOver = false;
+    bool gamePaused = true;
+    
+    int currentLevel = 1;
+    float time = 0; // seconds of unpaused play since the last reset
+    float spawnClock = 0;
+    float spawnCheckInterval = 1.0f/60; // spawn odds are tuned per 1/60 s check
+    int wordsTyped = 0;
+    int enemiesKilled = 0;
+    int peakEnemies = 0;
+    int peakFireballs = 0;
+    // spawning by waves when the schedule is not empty
+    WaveSchedule waves;
+    unsigned int waveIndex = 0;
+    float waveTime = 0;
+    float burstClock = 0;
+    std::vector<int> laneEnemies; // enemies alive per station
+    std::vector<std::string> words; // one word per station
+    std::vector<int> wordsBeginTypingIndex; // the character position of each word at which user should type next letter
+    uint32_t wordLetters = 0; // bit per first letter of the words on screen, bit 0 is 'a'
+    unsigned char wordLetterCounts[26] = {}; // words on screen per first letter
+    WordHistory wordHistory;
+    // typing at any lane: the words on screen as a prefix tree, the node the
+    // letters typed so far lead to, and the lane they are aimed at (-1: none)
+    bool anyLane = false;
+    WordTrie wordTrie{4};
+    int typedNode = WordTrie::root;
+    int typedLength = 0;
+    int targetLane = -1;
+    uint32_t shotSerial = 0; // counts typing attempts, which tag their fireballs
+    int shotsFired = 0;      // fireballs fired for the letters typed so far
+    
+    // input recording and replay; step counts control() calls
+    InputLog* recordLog = NULL;
+    const InputLog* replayLog = NULL;
+    uint32_t step = 0;
+    unsigned int nextReplayEvent = 0;
+    
+    void drainInput(InputQueue& input, double until);
+    bool keyPressed(const KeyEvent& event);
+    void destroyObject(Object* object);
+    void removeDeadObjects();
+    void trySpawn();
+    Enemy* spawnEnemy(int side, int health, float speed, float distance);
+    void updateWaves(float dt);
+    void assignWords();
+    bool setWord(int lane, StringView word);
+    void clearWord(int lane);
+    void handleTyping(const KeyEvent& event);
+    void handleAnyLaneTyping(const KeyEvent& event, int sample);
+    void shoot(int lane, int sample);
+    int fire(int lane, int count, int sample);
+    void retarget(int from, int to);
+    void completeWord(int lane);
+    int hudLane() { return anyLane && targetLane >= 0 ? targetLane : avatarPosition; }
+    // queue HUD text; draw() flushes it
+    void drawWord();
+    void drawOverlay(const ArenaVector<const char*>& lines);
+    
+public:
+    Scene() { setLaneCount(laneCount); }
+    // Number of stations (1 to maxLanes). Call before initialize(), which
+    // sizes the enemy and fireball pools for it; the rest applies at reset().
+    void setLaneCount(int count);
+    // spawn by this schedule instead of the classic rules (an empty one
+    // restores them); like setLaneCount(), call before initialize()
+    void setWaves(const WaveSchedule& schedule);
+    // the typing mode, station count and schedule a log was recorded with;
+    // its word weighting has to be set before the dictionary loads
+    void applyLogSettings(const InputLog& log);
+    void initialize();
+    ~Scene();
+    void reset();
+    void control(float dt, InputQueue& input, double until = HUGE_VAL);
+    void draw(float alpha, const ArenaVector<const char*>& overlay);
+    
+    Camera& getCamera() { return camera; }
+    Object* getAvatar() { return avatar; }
+    
+    void seed(uint64_t s) { rng.seed(s); }
+    
+    // reseed, reset and capture every key transition into log from now on
+    void record(InputLog* log, uint64_t seed, float dt);
+    // stores the session length and final state hash in the log being recorded
+    void stopRecording();
+    // reseed and reset from log, then take input from it instead of the queue
+    void replay(const InputLog* log);
+    bool isReplaying() { return replayLog != NULL; }
+    bool replayFinished() { return replayLog != NULL && step >= replayLog->steps; }
+    uint64_t stateHash();
+    bool isKeyHeld(int key) { return keysHeld.at(key); }
+    const std::vector<KeyEvent>& getStepEvents() { return stepEvents; }
+    void setVerbose(bool v) { verbose = v; }
+    // letters go to whichever lane's word they spell, without turning; takes effect on reset
+    void setAnyLane(bool enabled) { anyLane = enabled; }
+    bool isAnyLane() { return anyLane; }
+    int getTargetLane() { return targetLane; }
+    void setLatencyTracker(LatencyTracker* tracker) { latency = tracker; }
+    void setGpuTimers(GpuTimers* timers) { gpuTimers = timers; }
+    bool isGameOver() { return gameOver; }
+    bool isPaused() { return gamePaused; }
+    float getTime() { return time; }
+    int getLevel() { return currentLevel; }
+    GameStats getStats()
+    {
+        GameStats stats = { time, wordsTyped, enemiesKilled, currentLevel, peakEnemies, peakFireballs };
+        return stats;
+    }
+    int getLaneCount() { return laneCount; }
+    int getAvatarPosition() { return avatarPosition; }
+    const std::string& getWord(int position) { return words[position]; }
+    int getTypingIndex(int position) { return wordsBeginTypingIndex[position]; }
+};
+
+#endif /* Scene_hpp */
@@ -0,0 +1,95 @@
+//
+//  SyntheticInput.cpp
+//  Mario Typer
+//
+
+#import <stdio.h>
+#import <string.h>
+#import <fstream>
+#import <sstream>
+#import <string>
+#import "SyntheticInput.hpp"
+
+void Typist::control(float dt, Scene& scene, InputQueue& input)
+{
+    elapsed += dt;
+    if(scene.isGameOver())
+        return;
+    
+    clock += dt;
+    if(clock < 1/charsPerSecond)
+        return;
+    clock = fmod(clock, 1/charsPerSecond);
+    
+    int key = -1;
+    int lanes = scene.getLaneCount();
+    int position = scene.getAvatarPosition();
+    if(scene.isAnyLane()) {
+        position = scene.getTargetLane();
+        for(int offset=0; offset<lanes && position < 0; offset++) {
+            int lane = (scene.getAvatarPosition() + offset) % lanes;
+            if(scene.getWord(lane) != "")
+                position = lane;
+        }
+        if(position < 0)
+            position = scene.getAvatarPosition();
+    }
+    const std::string& word = scene.getWord(position);
+    if(scene.isPaused()) {
+        key = '2';
+    } else if(scene.getCamera().isMoving()) {
+        return;
+    } else if(word != "") {
+        key = word[scene.getTypingIndex(position)];
+        if(rng.uniform() > accuracy)
+            key = 'a' + (key - 'a' + rng.range(1, 25)) % 26;
+    } else if(!scene.isAnyLane()) {
+        // turn towards the closest station with a word; left goes to position+1
+        for(int offset=1; offset<=lanes/2 && key < 0; offset++) {
+            if(scene.getWord((position+offset) % lanes) != "")
+                key = KEY_LEFT;
+            else if(scene.getWord((position+lanes-offset) % lanes) != "")
+                key = KEY_RIGHT;
+        }
+    }
+    if(key >= 0)
+        tap(input, key);
+}
+
+InputScript::InputScript(const char* filename)
+{
+    std::ifstream file(filename);
+    if(!file.is_open()) {
+        printf("file %s not found\n", filename);
+        return;
+    }
+    std::string line;
+    while(std::getline(file, line)) {
+        std::istringstream row(line);
+        Tap tap;
+        std::string name;
+        if(!(row >> tap.time >> name) || name[0] == '#')
+            continue;
+        if(name.length() == 1) tap.key = (unsigned char)name[0];
+        else if(name == "up") tap.key = KEY_UP;
+        else if(name == "down") tap.key = KEY_DOWN;
+        else if(name == "left") tap.key = KEY_LEFT;
+        else if(name == "right") tap.key = KEY_RIGHT;
+        else if(name == "f1") tap.key = KEY_F1;
+        else if(name == "f2") tap.key = KEY_F2;
+        else {
+            printf("Unknown key '%s' in %s\n", name.c_str(), filename);
+            continue;
+        }
+        taps.push_back(tap);
+    }
+}
+
+void InputScript::control(float dt, Scene& scene, InputQueue& input)
+{
+    elapsed += dt;
+    while(next < taps.size() && taps[next].time <= elapsed) {
+        tap(input, taps[next].key);
+        next++;
+    }
+}
@@ -0,0 +1,74 @@
+//
+//  SyntheticInput.hpp
+//  Mario Typer
+//
+//  Keyboard input that does not come from a window: a simple bot typist and
+//  a scripted key sequence. Both drive a Scene through the same input queue
+//  the GLUT callbacks push key events into.
+//
+
+#ifndef SyntheticInput_hpp
+#define SyntheticInput_hpp
+
+#import <vector>
+#import "Random.hpp"
+#import "InputQueue.hpp"
+#import "Scene.hpp"
+
+class InputSource
+{
+protected:
+    double elapsed = 0; // seconds since reset, the timestamp of pushed events
+    // press and release key within the same step
+    void tap(InputQueue& input, int key)
+    {
+        KeyEvent down = { elapsed, (uint16_t)key, true };
+        KeyEvent up = { elapsed, (uint16_t)key, false };
+        input.push(down);
+        input.push(up);
+    }
+public:
+    virtual ~InputSource() {}
+    // called once per simulation step, before Scene::control
+    virtual void control(float dt, Scene& scene, InputQueue& input)=0;
+    virtual void reset() { elapsed = 0; }
+    virtual void seed(unsigned int s) {}
+};
+
+// Types the word in front of the avatar at a fixed rate, with occasional
+// wrong letters, and turns towards the nearest station that has a word.
+// When the scene takes typing at any lane it never turns, and types the
+// word it started on or else the nearest one.
+class Typist : public InputSource
+{
+    Random rng;
+    float charsPerSecond;
+    float accuracy;
+    float clock = 0;
+public:
+    Typist(unsigned int seed, float charsPerSecond = 6, float accuracy = 0.95f):
+    rng(seed), charsPerSecond(charsPerSecond), accuracy(accuracy) {}
+    void control(float dt, Scene& scene, InputQueue& input);
+    void reset() { InputSource::reset(); clock = 0; }
+    void seed(unsigned int s) { rng.seed(s); }
+};
+
+// Replays key taps from a text file, one "<seconds> <key>" pair per line.
+// key is a single character or one of: up down left right f1 f2.
+class InputScript : public InputSource
+{
+    struct Tap
+    {
+        float time;
+        int key;
+    };
+    std::vector<Tap> taps;
+    unsigned int next = 0;
+public:
+    InputScript(const char* filename);
+    bool isLoaded() { return taps.size() > 0; }
+    void control(float dt, Scene& scene, InputQueue& input);
+    void reset() { InputSource::reset(); next = 0; }
+};
+
+#endif /* SyntheticInput_hpp */
@@ -0,0 +1,232 @@
+//
+//  TextBatch.cpp
+//  Mario Typer
+//
+
+#import <stddef.h>
+#import <string.h>
+#import "TextBatch.hpp"
+#import "Metrics.hpp"
+
+// printable ASCII from ' ' to '~', a byte per row from the top, bit 4 the
+// leftmost pixel
+static const unsigned char glyphRows[95][TextBatch::glyphHeight] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, 0x00 }, // !
+    { 0x0a, 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00 }, // "
+    { 0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a, 0x00 }, // #
+    { 0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04, 0x00 }, // $
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03, 0x00 }, // %
+    { 0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d, 0x00 }, // &
+    { 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02, 0x00 }, // (
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08, 0x00 }, // )
+    { 0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00, 0x00 }, // *
+    { 0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00, 0x00 }, // +
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08 }, // ,
+    { 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00 }, // -
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c, 0x00 }, // .
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00 }, // /
+    { 0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e, 0x00 }, // 0
+    { 0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00 }, // 1
+    { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f, 0x00 }, // 2
+    { 0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e, 0x00 }, // 3
+    { 0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02, 0x00 }, // 4
+    { 0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e, 0x00 }, // 5
+    { 0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e, 0x00 }, // 6
+    { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08, 0x00 }, // 7
+    { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e, 0x00 }, // 8
+    { 0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c, 0x00 }, // 9
+    { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00, 0x00 }, // :
+    { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x04, 0x08, 0x00 }, // ;
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, 0x00 }, // <
+    { 0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00, 0x00 }, // =
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08, 0x00 }, // >
+    { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04, 0x00 }, // ?
+    { 0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e, 0x00 }, // @
+    { 0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11, 0x00 }, // A
+    { 0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e, 0x00 }, // B
+    { 0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e, 0x00 }, // C
+    { 0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c, 0x00 }, // D
+    { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f, 0x00 }, // E
+    { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10, 0x00 }, // F
+    { 0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f, 0x00 }, // G
+    { 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11, 0x00 }, // H
+    { 0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00 }, // I
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c, 0x00 }, // J
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11, 0x00 }, // K
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f, 0x00 }, // L
+    { 0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11, 0x00 }, // M
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x00 }, // N
+    { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00 }, // O
+    { 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10, 0x00 }, // P
+    { 0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d, 0x00 }, // Q
+    { 0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11, 0x00 }, // R
+    { 0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e, 0x00 }, // S
+    { 0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00 }, // T
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00 }, // U
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04, 0x00 }, // V
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a, 0x00 }, // W
+    { 0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11, 0x00 }, // X
+    { 0x11, 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x00 }, // Y
+    { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f, 0x00 }, // Z
+    { 0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e, 0x00 }, // [
+    { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00 }, // backslash
+    { 0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e, 0x00 }, // ]
+    { 0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ^
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x00 }, // _
+    { 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00 }, // `
+    { 0x00, 0x00, 0x0e, 0x01, 0x0f, 0x11, 0x0f, 0x00 }, // a
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1e, 0x00 }, // b
+    { 0x00, 0x00, 0x0e, 0x10, 0x10, 0x11, 0x0e, 0x00 }, // c
+    { 0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x0f, 0x00 }, // d
+    { 0x00, 0x00, 0x0e, 0x11, 0x1f, 0x10, 0x0e, 0x00 }, // e
+    { 0x06, 0x09, 0x08, 0x1c, 0x08, 0x08, 0x08, 0x00 }, // f
+    { 0x00, 0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x0e }, // g
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00 }, // h
+    { 0x04, 0x00, 0x0c, 0x04, 0x04, 0x04, 0x0e, 0x00 }, // i
+    { 0x02, 0x00, 0x06, 0x02, 0x02, 0x02, 0x12, 0x0c }, // j
+    { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12, 0x00 }, // k
+    { 0x0c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00 }, // l
+    { 0x00, 0x00, 0x1a, 0x15, 0x15, 0x11, 0x11, 0x00 }, // m
+    { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00 }, // n
+    { 0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e, 0x00 }, // o
+    { 0x00, 0x00, 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10 }, // p
+    { 0x00, 0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x01 }, // q
+    { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10, 0x00 }, // r
+    { 0x00, 0x00, 0x0f, 0x10, 0x0e, 0x01, 0x1e, 0x00 }, // s
+    { 0x08, 0x08, 0x1c, 0x08, 0x08, 0x09, 0x06, 0x00 }, // t
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d, 0x00 }, // u
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0a, 0x04, 0x00 }, // v
+    { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0a, 0x00 }, // w
+    { 0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x00 }, // x
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0f, 0x01, 0x0e }, // y
+    { 0x00, 0x00, 0x1f, 0x02, 0x04, 0x08, 0x1f, 0x00 }, // z
+    { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02, 0x00 }, // {
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00 }, // |
+    { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08, 0x00 }, // }
+    { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00 }, // ~
+};
+
+// the atlas: glyphs in 8x8 cells, 16 to a row, as white with alpha coverage
+static const int atlasColumns = 16;
+static const int atlasWidth = 128;
+static const int atlasHeight = 64;
+static const int cellSize = 8;
+
+void TextBatch::initialize()
+{
+    vertices.reserve(4*maxGlyphs);
+#ifndef HEADLESS
+    unsigned char pixels[atlasWidth*atlasHeight];
+    memset(pixels, 0, sizeof(pixels));
+    for(int glyph=0; glyph<95; glyph++) {
+        int left = (glyph % atlasColumns)*cellSize;
+        int top = (glyph / atlasColumns)*cellSize;
+        for(int row=0; row<glyphHeight; row++)
+            for(int column=0; column<glyphWidth; column++)
+                if(glyphRows[glyph][row] & (0x10 >> column))
+                    pixels[(top + row)*atlasWidth + left + column] = 255;
+    }
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlasWidth, atlasHeight, 0,
+                 GL_ALPHA, GL_UNSIGNED_BYTE, pixels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, 4*maxGlyphs*sizeof(Vertex), NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+TextBatch::~TextBatch()
+{
+#ifndef HEADLESS
+    if(buffer) glDeleteBuffers(1, &buffer);
+    if(texture) glDeleteTextures(1, &texture);
+#endif
+}
+
+void TextBatch::add(float x, float y, char c, int scale, uint32_t color)
+{
+    if(c == ' ' || vertices.size() >= 4*maxGlyphs)
+        return;
+    int glyph = (c >= ' ' && c <= '~') ? c - ' ' : '?' - ' ';
+    float u0 = (float)((glyph % atlasColumns)*cellSize) / atlasWidth;
+    float v0 = (float)((glyph / atlasColumns)*cellSize) / atlasHeight;
+    float u1 = u0 + (float)glyphWidth / atlasWidth;
+    float v1 = v0 + (float)glyphHeight / atlasHeight;
+    float x1 = x + glyphWidth*scale;
+    float y1 = y + glyphHeight*scale;
+    // the atlas stores rows from the top, so the quad's top edge takes v0
+    vertices.push_back({ x,  y,  u0, v1, color });
+    vertices.push_back({ x1, y,  u1, v1, color });
+    vertices.push_back({ x1, y1, u1, v0, color });
+    vertices.push_back({ x,  y1, u0, v0, color });
+}
+
+void TextBatch::add(float x, float y, const char* text, int scale, uint32_t color)
+{
+    for(; *text; text++, x += advance*scale)
+        add(x, y, *text, scale, color);
+}
+
+void TextBatch::flush(unsigned int windowWidth, unsigned int windowHeight)
+{
+    // the buffer is only created with a GL context, never in the headless build
+    if(!vertices.empty() && buffer)
+        draw(windowWidth, windowHeight);
+    vertices.clear();
+}
+
+void TextBatch::draw(unsigned int windowWidth, unsigned int windowHeight)
+{
+#ifndef HEADLESS
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(0.0, windowWidth, 0.0, windowHeight);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    Metrics::add(Metrics::TEXTURE_BINDS);
+    // vertex colour times the glyph's alpha coverage
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    
+    // orphan last frame's storage so the upload never waits for the GPU
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, 4*maxGlyphs*sizeof(Vertex), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size()*sizeof(Vertex), vertices.data());
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, x));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, u));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, color));
+    glDrawArrays(GL_QUADS, 0, (GLsizei)vertices.size());
+    Metrics::add(Metrics::DRAW_CALLS);
+    Metrics::add(Metrics::TRIANGLES, vertices.size()/2);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    glDisable(GL_TEXTURE_2D);
+    glEnable(GL_DEPTH_TEST);
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+#endif
+}
@@ -0,0 +1,63 @@
+//
+//  TextBatch.hpp
+//  Mario Typer
+//
+//  HUD text as textured quads. An embedded 5x8 bitmap font is rasterized
+//  into a glyph atlas texture once; every string of a frame is queued as
+//  quads with a colour per character and drawn with a single vertex buffer
+//  draw call, instead of a glutBitmapCharacter raster call per character.
+//
+
+#ifndef TextBatch_hpp
+#define TextBatch_hpp
+
+#import <stdint.h>
+#import <vector>
+#import "Platform.hpp"
+
+// RGBA bytes packed as a little-endian word, the order they are stored in
+// the vertex buffer
+inline uint32_t textColor(float r, float g, float b, float a = 1.0f)
+{
+    return (uint32_t)(r*255 + 0.5f) | (uint32_t)(g*255 + 0.5f) << 8
+         | (uint32_t)(b*255 + 0.5f) << 16 | (uint32_t)(a*255 + 0.5f) << 24;
+}
+
+class TextBatch
+{
+public:
+    static const int glyphWidth = 5;
+    static const int glyphHeight = 8; // the bottom row is for descenders
+    static const int advance = 6;     // pixels from one character to the next at scale 1
+    static const unsigned int maxGlyphs = 4096; // per frame, the rest is dropped
+
+private:
+    struct Vertex
+    {
+        float x, y;
+        float u, v;
+        uint32_t color;
+    };
+    std::vector<Vertex> vertices; // four per queued glyph, reserved for maxGlyphs
+    GLuint texture = 0;
+    GLuint buffer = 0;
+    
+    void draw(unsigned int windowWidth, unsigned int windowHeight);
+
+public:
+    // builds the atlas texture and vertex buffer; needs a current GL context
+    void initialize();
+    ~TextBatch();
+
+    // pixel coordinates from the bottom left corner of the window; scale
+    // is a whole number so glyph pixels stay square and sharp
+    void add(float x, float y, char c, int scale, uint32_t color);
+    void add(float x, float y, const char* text, int scale, uint32_t color);
+    static float width(unsigned int length, int scale) { return (float)(length*advance*scale); }
+
+    // draws everything queued since the last flush in one call, then empties the batch
+    void flush(unsigned int windowWidth, unsigned int windowHeight);
+    unsigned int size() const { return (unsigned int)vertices.size() / 4; }
+};
+
+#endif /* TextBatch_hpp */
@@ -0,0 +1,62 @@
+//
+//  Timestep.hpp
+//  Mario Typer
+//
+
+#ifndef Timestep_hpp
+#define Timestep_hpp
+
+#import <chrono>
+
+// seconds since the first call, from a steady high-resolution clock
+inline double monotonicSeconds()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Fixed-timestep clock. Wall-clock frame time is fed into an accumulator and
+// drained in whole simulation steps of 1/hz seconds, so gameplay runs at the
+// same rate no matter how fast frames are rendered. alpha() is the fraction
+// of a step left over, used to interpolate between the last two states.
+class FixedTimestep
+{
+    double step;
+    int maxSteps;
+    double accumulator = 0;
+    double lastTime = -1;
+    int lastSteps = 0;
+public:
+    FixedTimestep(double hz = 60, int maxSteps = 5):
+    step(1.0/hz), maxSteps(maxSteps) {}
+    
+    void setRate(double hz) { step = 1.0/hz; }
+    void setMaxSteps(int steps) { maxSteps = steps; }
+    double getStep() const { return step; }
+    
+    // returns how many simulation steps to run for the frame ending at time t
+    int advance(double t)
+    {
+        if(lastTime < 0) lastTime = t;
+        accumulator += t - lastTime;
+        lastTime = t;
+        int steps = 0;
+        while(accumulator >= step && steps < maxSteps) {
+            accumulator -= step;
+            steps++;
+        }
+        lastSteps = steps;
+        // too far behind (breakpoint, window drag): drop the backlog
+        // instead of spiralling into ever longer catch-up frames
+        if(steps == maxSteps && accumulator > step)
+            accumulator = 0;
+        return steps;
+    }
+    
+    float alpha() const { return (float)(accumulator / step); }
+    
+    // wall-clock time that step i of the last advance() catches up to
+    double stepTime(int i) const { return lastTime - accumulator - (lastSteps - 1 - i) * step; }
+};
+
+#endif /* Timestep_hpp */
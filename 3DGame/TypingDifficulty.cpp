@@ -0,0 +1,88 @@
+//
+//  TypingDifficulty.cpp
+//  Mario Typer
+//
+
+#import <math.h>
+#import "TypingDifficulty.hpp"
+
+// finger of each letter, 0-3 left pinky to index, 4-7 right index to pinky
+static const unsigned char fingers[26] = {
+//  a  b  c  d  e  f  g  h  i  j  k  l  m  n  o  p  q  r  s  t  u  v  w  x  y  z
+    0, 3, 2, 2, 2, 3, 3, 4, 5, 4, 5, 6, 4, 4, 6, 7, 0, 3, 1, 3, 4, 3, 1, 1, 4, 0
+};
+
+// 0 top, 1 home, 2 bottom
+static const unsigned char rows[26] = {
+//  a  b  c  d  e  f  g  h  i  j  k  l  m  n  o  p  q  r  s  t  u  v  w  x  y  z
+    1, 2, 2, 1, 0, 1, 1, 1, 0, 1, 1, 1, 2, 2, 0, 0, 0, 0, 1, 0, 0, 2, 0, 2, 0, 2
+};
+
+// letter frequency in English text, percent
+static const float frequencies[26] = {
+    8.17f, 1.49f, 2.78f, 4.25f, 12.70f, 2.23f, 2.02f, 6.09f, 6.97f, 0.15f, 0.77f, 4.03f, 2.41f,
+    6.75f, 7.51f, 1.93f, 0.10f, 5.99f, 6.33f, 9.06f, 2.76f, 0.98f, 2.36f, 0.15f, 1.97f, 0.07f
+};
+
+static const float rowCost[3] = { 1.2f, 1.0f, 1.4f };
+static const float fingerCost[8] = { 1.25f, 1.1f, 1.0f, 1.0f, 1.0f, 1.0f, 1.1f, 1.25f };
+static const float centreColumnCost = 0.1f;  // t g b y h n: the index finger reaches over
+static const float rarityCost = 0.12f;       // per halving of the letter's frequency below 'e'
+static const float sameFingerCost = 1.0f;    // two different letters on one finger
+static const float sameHandCost = 0.25f;     // no alternation between hands
+static const float rowJumpCost = 0.5f;       // top row to bottom row on one hand
+static const float doubleLetterCost = 0.1f;
+
+// cost[26][c] is the first letter of a word, cost[p][c] letter c after letter p
+struct ScoreTable
+{
+    float cost[27][26];
+
+    ScoreTable()
+    {
+        for(int c=0; c<26; c++) {
+            bool centre = c == 't'-'a' || c == 'g'-'a' || c == 'b'-'a' || c == 'y'-'a' || c == 'h'-'a' || c == 'n'-'a';
+            float letter = rowCost[rows[c]] * fingerCost[fingers[c]] + (centre ? centreColumnCost : 0)
+                           + rarityCost * log2f(frequencies['e'-'a'] / frequencies[c]);
+            cost[26][c] = letter;
+            for(int p=0; p<26; p++) {
+                float pair = 0;
+                bool sameHand = (fingers[p] < 4) == (fingers[c] < 4);
+                if(p == c) {
+                    pair = doubleLetterCost;
+                } else if(fingers[p] == fingers[c]) {
+                    pair = sameFingerCost;
+                } else if(sameHand) {
+                    pair = sameHandCost;
+                    if(rows[p] != 1 && rows[c] != 1 && rows[p] != rows[c])
+                        pair += rowJumpCost;
+                }
+                cost[p][c] = letter + pair;
+            }
+        }
+    }
+};
+
+static const ScoreTable& scoreTable()
+{
+    static const ScoreTable table;
+    return table;
+}
+
+void scoreWords(const char* blob, const uint32_t* offsets, unsigned int count, float* scores)
+{
+    const ScoreTable& table = scoreTable();
+    const unsigned char* text = (const unsigned char*)blob;
+    for(unsigned int i=0; i<count; i++) {
+        // the packed blob holds only a-z, checked when the list was read
+        uint32_t end = offsets[i+1];
+        float score = 0;
+        int previous = 26;
+        for(uint32_t at=offsets[i]; at<end; at++) {
+            int letter = text[at] - 'a';
+            score += table.cost[previous][letter];
+            previous = letter;
+        }
+        scores[i] = score;
+    }
+}
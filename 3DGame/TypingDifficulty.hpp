@@ -0,0 +1,24 @@
+//
+//  TypingDifficulty.hpp
+//  Mario Typer
+//
+//  How hard a word is to type on a QWERTY keyboard with touch typing. Each
+//  letter costs by its row and finger, more for letters that are rare in
+//  English, and each pair of letters by how the hands move between them:
+//  the same finger twice, jumps between the top and bottom rows, and staying
+//  on one hand instead of alternating all cost extra. All of that folds into
+//  one table indexed by (previous letter, letter), so scoring is a single
+//  lookup per letter over the packed word blob.
+//
+
+#ifndef TypingDifficulty_hpp
+#define TypingDifficulty_hpp
+
+#import <stdint.h>
+
+// Scores count lowercase a-z words stored back to back in blob, word i
+// running from offsets[i] to offsets[i+1], into scores[0] to scores[count-1].
+// An easy letter adds about 1 to a word's score.
+void scoreWords(const char* blob, const uint32_t* offsets, unsigned int count, float* scores);
+
+#endif /* TypingDifficulty_hpp */
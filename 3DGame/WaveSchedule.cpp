@@ -0,0 +1,131 @@
+//
+//  WaveSchedule.cpp
+//  Mario Typer
+//
+
+#import <stdio.h>
+#import <string.h>
+#import <math.h>
+#import <fstream>
+#import <sstream>
+#import "WaveSchedule.hpp"
+
+struct Preset
+{
+    const char* name;
+    const char* text;
+};
+
+// rush: three waves that get faster and tougher
+// stress-1k, stress-4k: fill up to 1000 or 4000 slow enemies spread far down
+// the stations, then hold there, with 16-fireball volleys; run the headless
+// build with a fast typist (--cps=30) to keep thousands of fireballs in flight
+static const Preset presets[] = {
+    { "rush",
+        "wave warm-up\n"
+        "    duration 30\n    level 1\n    interval 2\n    burst 1\n    cap 6\n    health 3 4\n"
+        "wave pressure\n"
+        "    duration 30\n    level 2\n    interval 1.2\n    burst 2\n    cap 12\n    health 4 6\n    speed 0.7\n"
+        "wave swarm\n"
+        "    duration 60\n    level 3\n    interval 0.8\n    burst 3\n    cap 24\n    health 5 8\n    speed 0.8\n" },
+    { "stress-1k",
+        "fireballs 8192\n"
+        "wave fill\n"
+        "    duration 20\n    interval 0.05\n    burst 50\n    cap 1000\n    health 20 20\n"
+        "    speed 0.05\n    spread 60\n    volley 16\n"
+        "wave hold\n"
+        "    duration 600\n    interval 0.1\n    burst 20\n    cap 1000\n    health 20 40\n"
+        "    speed 0.05\n    spread 60\n    volley 16\n" },
+    { "stress-4k",
+        "fireballs 16384\n"
+        "wave fill\n"
+        "    duration 20\n    interval 0.05\n    burst 200\n    cap 4000\n    health 20 20\n"
+        "    speed 0.05\n    spread 60\n    volley 16\n"
+        "wave hold\n"
+        "    duration 600\n    interval 0.1\n    burst 80\n    cap 4000\n    health 20 40\n"
+        "    speed 0.05\n    spread 60\n    volley 16\n" },
+};
+
+const char* const* wavePresets()
+{
+    static const char* names[] = { presets[0].name, presets[1].name, presets[2].name, NULL };
+    return names;
+}
+
+int Wave::health(float t) const
+{
+    float f = duration > 0 ? fminf(t / duration, 1) : 0;
+    int h = (int)roundf(healthStart + (healthEnd - healthStart)*f);
+    return h > 1 ? h : 1;
+}
+
+bool WaveSchedule::parse(const std::string& source, const char* origin)
+{
+    clear();
+    std::istringstream lines(source);
+    std::string line;
+    int number = 0;
+    const char* problem = NULL;
+    while(!problem && std::getline(lines, line)) {
+        number++;
+        std::istringstream row(line);
+        std::string key;
+        if(!(row >> key) || key[0] == '#')
+            continue;
+        Wave* wave = waves.empty() ? NULL : &waves.back();
+        bool ok = true;
+        if(key == "fireballs") {
+            long long n = 0;
+            ok = !!(row >> n) && n >= 1 && n <= maxWaveFireballs;
+            if(ok) fireballs = (unsigned int)n;
+        }
+        else if(key == "wave") { waves.push_back(Wave()); row >> waves.back().name; }
+        else if(!wave) problem = "needs a 'wave' line first";
+        else if(key == "duration") ok = !!(row >> wave->duration) && wave->duration > 0;
+        else if(key == "level") ok = !!(row >> wave->level) && wave->level >= 1 && wave->level <= 3;
+        else if(key == "interval") ok = !!(row >> wave->interval) && wave->interval > 0;
+        else if(key == "burst") ok = !!(row >> wave->burst) && wave->burst >= 0;
+        else if(key == "cap") ok = !!(row >> wave->cap) && wave->cap >= 0 && wave->cap <= maxWaveEnemies;
+        else if(key == "health") ok = !!(row >> wave->healthStart >> wave->healthEnd);
+        else if(key == "speed") ok = !!(row >> wave->speed) && wave->speed > 0;
+        else if(key == "spread") ok = !!(row >> wave->spread) && wave->spread >= 0;
+        else if(key == "volley") ok = !!(row >> wave->volley) && wave->volley >= 1;
+        else problem = "has an unknown setting";
+        if(!ok)
+            problem = "has a missing or out of range value";
+    }
+    if(problem)
+        printf("Wave schedule %s %s (line %d)\n", origin, problem, number);
+    else if(waves.empty())
+        printf("Wave schedule %s has no waves\n", origin);
+    if(problem || waves.empty()) {
+        clear();
+        return false;
+    }
+    text = source;
+    return true;
+}
+
+bool WaveSchedule::load(const char* nameOrFile)
+{
+    for(const Preset& preset : presets)
+        if(strcmp(preset.name, nameOrFile) == 0)
+            return parse(preset.text, nameOrFile);
+    std::ifstream file(nameOrFile);
+    if(!file.is_open()) {
+        printf("file %s not found\n", nameOrFile);
+        return false;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return parse(contents.str(), nameOrFile);
+}
+
+unsigned int WaveSchedule::maxEnemies() const
+{
+    unsigned int most = 0;
+    for(const Wave& wave : waves)
+        if((unsigned int)wave.cap > most)
+            most = wave.cap;
+    return most;
+}
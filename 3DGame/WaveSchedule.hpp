@@ -0,0 +1,84 @@
+//
+//  WaveSchedule.hpp
+//  Mario Typer
+//
+//  Spawning by waves instead of the classic one-enemy-per-empty-station
+//  roll. A schedule is a text file of waves played in order, starting over
+//  after the last one. Each wave spawns bursts of enemies into random
+//  stations at a fixed interval, up to a cap on enemies alive, with health
+//  that ramps from one value to another over the wave. A station with
+//  enemies gets a word, and each letter of it fires a volley of fireballs
+//  at them. Words no longer set enemy health in this mode.
+//
+//      # comment
+//      fireballs 4096      fireball pool size, if the default is too small (up to 65536)
+//      wave <name>
+//          duration 30     seconds
+//          level 1         word difficulty, 1 to 3
+//          interval 1      seconds between bursts
+//          burst 1         enemies per burst
+//          cap 16          no bursts while this many enemies are alive (up to 16384)
+//          health 3 5      at the start and the end of the wave
+//          speed 0.6       units per second towards the player, more than 0
+//          spread 0        enemies start up to this much further out than the station
+//          volley 1        fireballs per typed letter
+//
+//  A few schedules are built in (see wavePresets()) for play and for
+//  profiling at worst-case entity counts.
+//
+
+#ifndef WaveSchedule_hpp
+#define WaveSchedule_hpp
+
+#import <string>
+#import <vector>
+
+// the pools are reserved up front at these sizes, so they are bounded
+const int maxWaveEnemies = 16384;
+const int maxWaveFireballs = 65536;
+
+struct Wave
+{
+    std::string name;
+    float duration = 30;
+    int level = 1;
+    float interval = 1;
+    int burst = 1;
+    int cap = 16;
+    float healthStart = 3;
+    float healthEnd = 3;
+    float speed = 0.6f;
+    float spread = 0;
+    int volley = 1;
+
+    // health of an enemy spawned t seconds into the wave
+    int health(float t) const;
+};
+
+class WaveSchedule
+{
+    std::vector<Wave> waves;
+    std::string text; // what it was parsed from, kept for input logs
+    unsigned int fireballs = 0;
+
+public:
+    // false, with a message naming origin, if the text has an error; the schedule is left empty
+    bool parse(const std::string& text, const char* origin);
+    // a built-in preset by name, otherwise a file
+    bool load(const char* nameOrFile);
+    void clear() { waves.clear(); text.clear(); fireballs = 0; }
+
+    bool empty() const { return waves.empty(); }
+    unsigned int size() const { return (unsigned int)waves.size(); }
+    const Wave& operator[](unsigned int i) const { return waves[i]; }
+    const std::string& source() const { return text; }
+
+    // pool sizes the schedule needs; 0 when it has no waves
+    unsigned int maxEnemies() const;
+    unsigned int maxFireballs() const { return fireballs; }
+};
+
+// names of the built-in schedules, NULL-terminated
+const char* const* wavePresets();
+
+#endif /* WaveSchedule_hpp */
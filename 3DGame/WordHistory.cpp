@@ -0,0 +1,73 @@
+//
+//  WordHistory.cpp
+//  Mario Typer
+//
+
+#import "WordHistory.hpp"
+
+void WordHistory::rebuild(const PackedWords* levels)
+{
+    tables = levels;
+    uint32_t total = 0;
+    for(int level=0; level<3; level++) {
+        levelStart[level] = total;
+        total += levels[level].count();
+    }
+    recentBits.assign((total + 63) / 64, 0);
+    ring.clear();
+    next = 0;
+}
+
+void WordHistory::clear()
+{
+    // sized for the tables now, so a game's first draw does not allocate
+    const PackedWords* levels = currentDictionary();
+    if(levels != tables) {
+        rebuild(levels);
+        return;
+    }
+    for(uint32_t id : ring)
+        recentBits[id >> 6] &= ~(1ull << (id & 63));
+    ring.clear();
+    next = 0;
+}
+
+void WordHistory::remember(uint32_t id)
+{
+    if(ring.size() < capacity) {
+        ring.push_back(id);
+    } else {
+        uint32_t oldest = ring[next];
+        recentBits[oldest >> 6] &= ~(1ull << (oldest & 63));
+        ring[next] = id;
+        next = (next + 1) % capacity;
+    }
+    recentBits[id >> 6] |= 1ull << (id & 63);
+}
+
+StringView WordHistory::pick(int level, Random& rng, uint32_t usedLetters)
+{
+    StringView none = { "", 0 };
+    if(level < 1 || level > 3)
+        return none;
+    // word numbers change when a streaming load publishes new tables
+    const PackedWords* levels = currentDictionary();
+    if(levels != tables)
+        rebuild(levels);
+    const PackedWords& words = levels[level-1];
+    if(words.count() == 0)
+        return none;
+    bool avoidRecent = words.count() > 4*capacity;
+    for(int attempt=0; attempt<maxAttempts; attempt++) {
+        unsigned int n = words.sample(rng);
+        StringView word = words.word(n);
+        if(usedLetters & (1u << (word.data[0] - 'a')))
+            continue;
+        uint32_t id = levelStart[level-1] + n;
+        if(avoidRecent && isRecent(id))
+            continue;
+        remember(id);
+        return word;
+    }
+    return none;
+}
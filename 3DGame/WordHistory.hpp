@@ -0,0 +1,48 @@
+//
+//  WordHistory.hpp
+//  Mario Typer
+//
+//  Keeps the game from handing out a word that was drawn recently or that
+//  starts with the same letter as a word still on screen. The last few words
+//  drawn sit in a ring buffer of word numbers, mirrored by one bit per word
+//  of the dictionary, so each check is a single bit test; the letters in use
+//  are a 26-bit mask the Scene passes in. Nothing allocates except when the
+//  dictionary tables themselves are swapped.
+//
+
+#ifndef WordHistory_hpp
+#define WordHistory_hpp
+
+#import <stdint.h>
+#import <vector>
+#import "Dictionary.hpp"
+#import "Random.hpp"
+
+class WordHistory
+{
+    const PackedWords* tables = NULL; // the tables the word numbers refer to
+    uint32_t levelStart[3] = {};      // word number of each level's first word
+    std::vector<uint64_t> recentBits;
+    std::vector<uint32_t> ring;
+    unsigned int capacity;
+    unsigned int next = 0;
+
+    void rebuild(const PackedWords* levels);
+    bool isRecent(uint32_t id) const { return (recentBits[id >> 6] >> (id & 63)) & 1; }
+    void remember(uint32_t id);
+
+public:
+    static const int maxAttempts = 16;
+
+    WordHistory(unsigned int capacity = 64):capacity(capacity) { ring.reserve(capacity); }
+
+    // forgets every word, for a new game
+    void clear();
+    // Like pickRandomWord(), but never a word among the last capacity drawn
+    // (unless the level has too few words to spare them) and never one whose
+    // first letter is set in usedLetters (bit 0 is 'a'). Gives up with an
+    // empty word after maxAttempts draws; the caller tries again later.
+    StringView pick(int level, Random& rng, uint32_t usedLetters);
+};
+
+#endif /* WordHistory_hpp */
@@ -0,0 +1,31 @@
+//
+//  WordSource.cpp
+//  Mario Typer
+//
+
+#import "WordSource.hpp"
+
+FileWordSource::~FileWordSource()
+{
+    if(file)
+        fclose(file);
+}
+
+bool FileWordSource::open()
+{
+    if(file)
+        fclose(file);
+    file = fopen(path.c_str(), "rb");
+    if(!file) {
+        printf("Could not open word list %s\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t FileWordSource::read(char* buffer, size_t capacity)
+{
+    if(!file)
+        return 0;
+    return fread(buffer, 1, capacity, file);
+}
@@ -0,0 +1,44 @@
+//
+//  WordSource.hpp
+//  Mario Typer
+//
+//  Where word lists come from. The dictionary loader only asks a source for
+//  the next chunk of bytes, so a list can be any size, in any order, and in
+//  UTF-8; splitting into lines and sorting words into buckets happens in
+//  WordListBuilder (Dictionary.hpp).
+//
+
+#ifndef WordSource_hpp
+#define WordSource_hpp
+
+#import <stdio.h>
+#import <stddef.h>
+#import <string>
+
+class WordSource
+{
+public:
+    virtual ~WordSource() {}
+    // for log lines
+    virtual const char* name() const = 0;
+    virtual bool open() = 0;
+    // copies up to capacity bytes into buffer; 0 at the end of the list
+    virtual size_t read(char* buffer, size_t capacity) = 0;
+};
+
+// a word list on disk, one word per line (anything after a space or tab is ignored)
+class FileWordSource : public WordSource
+{
+    std::string path;
+    FILE* file = NULL;
+
+public:
+    FileWordSource(const char* path):path(path) {}
+    ~FileWordSource();
+
+    const char* name() const { return path.c_str(); }
+    bool open();
+    size_t read(char* buffer, size_t capacity);
+};
+
+#endif /* WordSource_hpp */
@@ -0,0 +1,130 @@
+//
+//  WordTrie.cpp
+//  Mario Typer
+//
+
+#import "WordTrie.hpp"
+
+WordTrie::WordTrie(unsigned int maxWords, unsigned int maxLength):
+nodes(1 + maxWords*maxLength), path(maxLength + 1), maxLength(maxLength)
+{
+    clear();
+}
+
+void WordTrie::clear()
+{
+    Node& top = nodes[root];
+    top.firstChild = top.nextSibling = -1;
+    top.count = 0;
+    top.lane = top.endLane = -1;
+    top.letter = 0;
+    freeList = -1;
+    for(int32_t i = (int32_t)nodes.size()-1; i > root; i--) {
+        nodes[i].count = 0;
+        nodes[i].nextSibling = freeList;
+        freeList = i;
+    }
+}
+
+int32_t WordTrie::allocate(char letter, int lane)
+{
+    int32_t i = freeList;
+    freeList = nodes[i].nextSibling;
+    Node& node = nodes[i];
+    node.firstChild = node.nextSibling = -1;
+    node.count = 0;
+    node.lane = lane;
+    node.endLane = -1;
+    node.letter = letter;
+    return i;
+}
+
+bool WordTrie::insert(const char* word, unsigned int length, int lane)
+{
+    if(length == 0 || length > maxLength)
+        return false;
+    // check the whole path first, so a failed insert changes nothing
+    unsigned int matched = 0;
+    int node = root;
+    while(matched < length) {
+        int next = child(node, word[matched]);
+        if(next < 0)
+            break;
+        node = next;
+        matched++;
+    }
+    if(matched == length && nodes[node].endLane >= 0)
+        return false;
+    unsigned int needed = length - matched;
+    int32_t free = freeList;
+    for(unsigned int i=0; i<needed; i++) {
+        if(free < 0)
+            return false;
+        free = nodes[free].nextSibling;
+    }
+
+    node = root;
+    nodes[root].count++;
+    for(unsigned int i=0; i<length; i++) {
+        int next = child(node, word[i]);
+        if(next < 0) {
+            next = allocate(word[i], lane);
+            nodes[next].nextSibling = nodes[node].firstChild;
+            nodes[node].firstChild = next;
+        }
+        node = next;
+        nodes[node].count++;
+    }
+    nodes[node].endLane = lane;
+    return true;
+}
+
+int WordTrie::laneThrough(int32_t node) const
+{
+    if(nodes[node].endLane >= 0)
+        return nodes[node].endLane;
+    return nodes[nodes[node].firstChild].lane;
+}
+
+void WordTrie::remove(const char* word, unsigned int length)
+{
+    if(length == 0 || length > maxLength)
+        return;
+    path[0] = root;
+    for(unsigned int i=0; i<length; i++) {
+        path[i+1] = child(path[i], word[i]);
+        if(path[i+1] < 0)
+            return;
+    }
+    if(nodes[path[length]].endLane < 0)
+        return;
+    int lane = nodes[path[length]].endLane;
+    nodes[path[length]].endLane = -1;
+
+    // deepest first, so a node that keeps its lane from a child sees the child already fixed
+    for(int i = (int)length; i >= 0; i--) {
+        Node& node = nodes[path[i]];
+        node.count--;
+        if(node.count > 0) {
+            if(node.lane == lane)
+                node.lane = laneThrough(path[i]);
+            continue;
+        }
+        if(i == 0) {
+            node.lane = -1;
+            continue;
+        }
+        // unlink from the parent and put on the free list
+        Node& parent = nodes[path[i-1]];
+        if(parent.firstChild == path[i]) {
+            parent.firstChild = node.nextSibling;
+        } else {
+            int32_t previous = parent.firstChild;
+            while(nodes[previous].nextSibling != path[i])
+                previous = nodes[previous].nextSibling;
+            nodes[previous].nextSibling = node.nextSibling;
+        }
+        node.nextSibling = freeList;
+        freeList = path[i];
+    }
+}
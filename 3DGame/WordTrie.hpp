@@ -0,0 +1,61 @@
+//
+//  WordTrie.hpp
+//  Mario Typer
+//
+//  Prefix tree over the words on screen, so a letter can be matched against
+//  every lane at once: the player's position is a node, and each keystroke
+//  moves to one of its children. Every node knows a lane whose word runs
+//  through it, which is where the shot goes, and the lane whose word ends
+//  there, if any. Nodes come from a pool sized for maxWords words of up to
+//  maxLength letters, so inserting, removing and matching never allocate.
+//
+
+#ifndef WordTrie_hpp
+#define WordTrie_hpp
+
+#import <stdint.h>
+#import <vector>
+
+class WordTrie
+{
+    struct Node
+    {
+        int32_t firstChild;
+        int32_t nextSibling;
+        int32_t count;   // words through this node; 0 when on the free list
+        int32_t lane;    // a lane whose word has this prefix
+        int32_t endLane; // the lane whose word is exactly this prefix, -1 if none
+        char letter;
+    };
+    std::vector<Node> nodes;
+    std::vector<int32_t> path; // scratch for remove()
+    int32_t freeList = -1;     // linked through nextSibling
+    unsigned int maxLength;
+
+    int32_t allocate(char letter, int lane);
+    // the lane of any word through node, other than the one being removed
+    int laneThrough(int32_t node) const;
+
+public:
+    static const int root = 0;
+
+    WordTrie(unsigned int maxWords, unsigned int maxLength = 10);
+
+    void clear();
+    // false if the word is already on screen, too long, or the pool is full
+    bool insert(const char* word, unsigned int length, int lane);
+    void remove(const char* word, unsigned int length);
+
+    // the node after typing letter at node, -1 if no word continues that way
+    int child(int node, char letter) const
+    {
+        for(int32_t i = nodes[node].firstChild; i >= 0; i = nodes[i].nextSibling)
+            if(nodes[i].letter == letter)
+                return i;
+        return -1;
+    }
+    int lane(int node) const { return nodes[node].lane; }
+    int endLane(int node) const { return nodes[node].endLane; }
+};
+
+#endif /* WordTrie_hpp */
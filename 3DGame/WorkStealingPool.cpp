@@ -0,0 +1,68 @@
+//
+//  WorkStealingPool.cpp
+//  Mario Typer
+//
+
+#import <thread>
+#import "WorkStealingPool.hpp"
+
+WorkStealingPool::WorkStealingPool(int threads)
+{
+    if(threads < 1) threads = 1;
+    for(int i=0; i<threads; i++)
+        workers.push_back(new Worker());
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    for(Worker* worker : workers)
+        delete worker;
+}
+
+bool WorkStealingPool::takeJob(int worker, int& job)
+{
+    std::lock_guard<std::mutex> guard(workers[worker]->lock);
+    if(workers[worker]->jobs.empty())
+        return false;
+    job = workers[worker]->jobs.back();
+    workers[worker]->jobs.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::stealJob(int worker, int& job)
+{
+    for(int i=1; i<(int)workers.size(); i++) {
+        Worker* victim = workers[(worker + i) % workers.size()];
+        std::lock_guard<std::mutex> guard(victim->lock);
+        if(!victim->jobs.empty()) {
+            job = victim->jobs.front();
+            victim->jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(int count, std::function<void(int worker, int index)> job)
+{
+    // contiguous slices, so a worker without steals runs its jobs in order
+    int n = (int)workers.size();
+    for(int w=0; w<n; w++) {
+        int begin = (int)((long long)count * w / n);
+        int end = (int)((long long)count * (w+1) / n);
+        for(int i=end-1; i>=begin; i--)
+            workers[w]->jobs.push_back(i);
+    }
+    
+    // no job spawns new jobs, so a worker that finds every deque empty is done
+    std::vector<std::thread> threads;
+    for(int w=0; w<n; w++) {
+        threads.push_back(std::thread([this, w, &job]() {
+            int index;
+            while(takeJob(w, index) || stealJob(w, index))
+                job(w, index);
+        }));
+    }
+    for(std::thread& thread : threads)
+        thread.join();
+}
@@ -0,0 +1,37 @@
+//
+//  WorkStealingPool.hpp
+//  Mario Typer
+//
+//  Runs a batch of independent jobs on a fixed set of threads. Each worker
+//  owns a deque of job indices; it takes work from the back of its own deque
+//  and, once that is empty, steals from the front of the other workers'.
+//
+
+#ifndef WorkStealingPool_hpp
+#define WorkStealingPool_hpp
+
+#import <deque>
+#import <functional>
+#import <mutex>
+#import <vector>
+
+class WorkStealingPool
+{
+    struct Worker
+    {
+        std::mutex lock;
+        std::deque<int> jobs;
+    };
+    std::vector<Worker*> workers;
+    
+    bool takeJob(int worker, int& job);
+    bool stealJob(int worker, int& job);
+public:
+    WorkStealingPool(int threads);
+    ~WorkStealingPool();
+    int size() { return (int)workers.size(); }
+    // calls job(worker, index) for every index in [0, count) and waits for all of them
+    void run(int count, std::function<void(int worker, int index)> job);
+};
+
+#endif /* WorkStealingPool_hpp */
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <math.h>
+#include "float3.h"
+#include "float4.h"
+
+// 4x4 matrix stored column-major, so that m can be handed directly to
+// glLoadMatrixf/glMultMatrixf. Element (row r, column c) lives at m[c*4 + r].
+class float4x4
+{
+public:
+	float m[16];
+
+	float4x4()
+	{
+		for(int i=0; i<16; i++)
+			m[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+	}
+
+	float4x4(const float* columnMajor)
+	{
+		for(int i=0; i<16; i++)
+			m[i] = columnMajor[i];
+	}
+
+	static float4x4 identity()
+	{
+		return float4x4();
+	}
+
+	static float4x4 translation(const float3& t)
+	{
+		float4x4 r;
+		r.m[12] = t.x;
+		r.m[13] = t.y;
+		r.m[14] = t.z;
+		return r;
+	}
+
+	static float4x4 scaling(const float3& s)
+	{
+		float4x4 r;
+		r.m[0] = s.x;
+		r.m[5] = s.y;
+		r.m[10] = s.z;
+		return r;
+	}
+
+	// same matrix as glRotatef(angle, axis.x, axis.y, axis.z), angle in degrees
+	static float4x4 rotation(float angle, float3 axis)
+	{
+		float4x4 r;
+		float len = axis.norm();
+		if(len == 0)
+			return r;
+		axis = axis / len;
+		float theta = angle / 180.0f * M_PI;
+		float c = cosf(theta);
+		float s = sinf(theta);
+		float t = 1.0f - c;
+		float x = axis.x;
+		float y = axis.y;
+		float z = axis.z;
+		r.m[0] = x*x*t + c;
+		r.m[1] = y*x*t + z*s;
+		r.m[2] = x*z*t - y*s;
+		r.m[4] = x*y*t - z*s;
+		r.m[5] = y*y*t + c;
+		r.m[6] = y*z*t + x*s;
+		r.m[8] = x*z*t + y*s;
+		r.m[9] = y*z*t - x*s;
+		r.m[10] = z*z*t + c;
+		return r;
+	}
+
+	float& operator()(int row, int col)
+	{
+		return m[col*4 + row];
+	}
+
+	float operator()(int row, int col) const
+	{
+		return m[col*4 + row];
+	}
+
+	float4x4 operator*(const float4x4& o) const
+	{
+		float4x4 r;
+		for(int col=0; col<4; col++)
+			for(int row=0; row<4; row++)
+				r.m[col*4 + row] =
+					m[0*4 + row] * o.m[col*4 + 0] +
+					m[1*4 + row] * o.m[col*4 + 1] +
+					m[2*4 + row] * o.m[col*4 + 2] +
+					m[3*4 + row] * o.m[col*4 + 3];
+		return r;
+	}
+
+	float4x4& operator*=(const float4x4& o)
+	{
+		*this = *this * o;
+		return *this;
+	}
+
+	float4 operator*(const float4& v) const
+	{
+		return float4(
+			m[0]*v.x + m[4]*v.y + m[8]*v.z + m[12]*v.w,
+			m[1]*v.x + m[5]*v.y + m[9]*v.z + m[13]*v.w,
+			m[2]*v.x + m[6]*v.y + m[10]*v.z + m[14]*v.w,
+			m[3]*v.x + m[7]*v.y + m[11]*v.z + m[15]*v.w);
+	}
+
+	// transform a point (w = 1), ignoring the projective row
+	float3 transformPoint(const float3& p) const
+	{
+		return float3(
+			m[0]*p.x + m[4]*p.y + m[8]*p.z + m[12],
+			m[1]*p.x + m[5]*p.y + m[9]*p.z + m[13],
+			m[2]*p.x + m[6]*p.y + m[10]*p.z + m[14]);
+	}
+
+	// transform a direction (w = 0)
+	float3 transformDirection(const float3& d) const
+	{
+		return float3(
+			m[0]*d.x + m[4]*d.y + m[8]*d.z,
+			m[1]*d.x + m[5]*d.y + m[9]*d.z,
+			m[2]*d.x + m[6]*d.y + m[10]*d.z);
+	}
+
+	// component-wise blend, good enough between two nearby simulation states
+	static float4x4 lerp(const float4x4& a, const float4x4& b, float t)
+	{
+		float4x4 r;
+		for(int i=0; i<16; i++)
+			r.m[i] = a.m[i] + (b.m[i] - a.m[i]) * t;
+		return r;
+	}
+
+	float3 getTranslation() const
+	{
+		return float3(m[12], m[13], m[14]);
+	}
+
+};